@@ -0,0 +1,1851 @@
+/*
+ *
+ * x11-fractal.h
+ *
+ * Code shared by x11-julia and x11-mandlebrot - everything apart from the
+ * kernels that count the iterations and the view each program draws.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.   See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.   If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Before including this file each program must define NAME, VERSION and
+ * BUILD, MAGIC and FORMAT (which identify its requests, replies and saved
+ * files) and VIEW (which describes the '--window' option), and after it
+ * must define v_render_tile(), b_symmetric(), v_mirror() and v_view().
+ *
+ * 18 Oct 26            - Moved the code shared by both programs here
+ *
+ */
+
+/* Distributed rendering needs BSD sockets and loading a saved file in
+   place needs mmap(), so either can be left out by defining NO_SOCKETS or
+   NO_MMAP on hosts that don't have them (they are always left out on VMS).
+   Without mmap() saved files are read into memory instead. */
+
+#if !defined(NO_SOCKETS) && !defined(__VMS)
+#define  SOCKETS
+#endif
+#if !defined(NO_MMAP) && !defined(__VMS)
+#define  MMAP
+#endif
+
+#include <stdio.h>                        /* fprintf(), etc. */
+#include <stdlib.h>                       /* exit(), etc. */
+#include <string.h>                       /* strlen(), etc */
+#include <stdarg.h>                       /* va_start(), va_end(), etc */
+#include <stdint.h>
+
+#include <math.h>
+
+#include <sys/time.h>                     /* gettimeofday() */
+
+#if defined(SOCKETS) || defined(MMAP)
+#include <unistd.h>                       /* close(), sleep(), unlink() */
+#include <fcntl.h>                        /* open(), fcntl() */
+#include <sys/stat.h>                     /* fstat(), lstat() */
+#endif
+#if defined(SOCKETS)
+#include <signal.h>                       /* signal(), SIGPIPE */
+#include <errno.h>                        /* errno, EAGAIN */
+#include <sys/select.h>                   /* select(), FD_SET(), etc. */
+#include <sys/socket.h>                   /* socket(), bind(), etc. */
+#include <sys/un.h>                       /* sockaddr_un */
+#include <netinet/in.h>                   /* htonl(), ntohl(), etc. */
+#include <arpa/inet.h>
+#include <netdb.h>                        /* getaddrinfo() */
+#endif
+#if defined(MMAP)
+#include <sys/mman.h>                     /* mmap(), munmap() */
+#endif
+
+#include <X11/Xlib.h>                     /* XOpenDisplay(), etc. */
+#include <X11/Xatom.h>                    /* XA_ATOM */
+#include <X11/keysym.h>
+
+
+#if defined(DEBUG)
+#define debug(code) do {fprintf(stderr, "Debug\t: %s line : %d : ", \
+            __FILE__, __LINE__); code;} while(0)
+#else
+#define debug(code)
+#endif
+
+#define  WIDTH 800                        /* Define window size */
+#define  HEIGHT 600
+
+#define  TILE 64                          /* Tile size in pixels */
+#define  WORKERS 64                       /* Maximum number of workers */
+#define  TIMEOUT 2000                     /* Time before a slow tile is also given to another worker (ms) */
+#define  RETRY 10                         /* Number of attempts to connect to the coordinator */
+#define  REQUEST 24                       /* Number of words in a request */
+#define  REPLY 4                          /* Number of words in a reply header */
+#define  REPLY_SIZE (REPLY * 4 + TILE * TILE * 6) /* Largest reply in bytes */
+#define  HEADER 22                        /* Number of words in a saved file header */
+#define  ORDER 0x01020304                 /* Shows the byte order of the host that saved a file */
+#define  FRAME 0                          /* Saved frame is stored as is, so it can be used in place */
+#define  TILES 1                          /* Saved frame is stored as separately encoded tiles */
+#define  RAW 0                            /* Tile is stored as is */
+#define  RLE 1                            /* Tile is stored as runs of identical pixels */
+#define  FLOAT 0                          /* Iterate using floating point */
+#define  FIXED32 1                        /* Iterate using 32 bit fixed point */
+#define  FIXED64 2                        /* Iterate using 64 bit fixed point */
+#define  Q32 27                           /* Fraction bits in 32 bit fixed point (Q4.27) */
+#define  Q64 56                           /* Fraction bits in 64 bit fixed point (Q7.56) */
+#define  RANGE32 8                        /* Largest coordinate the 32 bit fixed point kernel can use */
+#define  RANGE64 64                       /* Largest coordinate the 64 bit fixed point kernel can use */
+#define  LANES 16                        /* Pixels iterated together by the fixed point kernels */
+#define  WINDOWS 16                       /* Maximum number of windows */
+#define  INTERACTIVE 0                    /* Window has the focus or the pointer */
+#define  VISIBLE 1                        /* Window can be seen */
+#define  BACKGROUND 2                     /* Window is covered or not mapped */
+
+typedef struct {                          /* What to draw */
+   double f_xmin, f_xmax;                 /* Left and right edges */
+   double f_ymin, f_ymax;                 /* Top and bottom edges */
+   double cr, ci;                         /* Coefficients (julia set only) */
+   unsigned int i_width, i_height;        /* Image size in pixels */
+   unsigned int i_maxiteration;           /* Iterations */
+   unsigned int i_kernel;                 /* FLOAT, FIXED32 or FIXED64 */
+   int b_smooth;                          /* Calculate smoothed iterations */
+} t_view;
+
+typedef struct {                          /* Part of the image */
+   unsigned int i_left, i_top;            /* Location of the top-left corner */
+   unsigned int i_width, i_height;        /* Size in pixels */
+   int b_done;                            /* Result has been drawn */
+   int i_copies;                          /* Number of workers rendering it */
+   long i_start;                          /* Time first handed out (ms) */
+} t_tile;
+
+typedef struct {                          /* Connection to a worker */
+   int i_socket;
+   int b_busy;                            /* Waiting for a reply */
+   int i_window;                          /* Window the tile belongs to */
+   int i_tile;                            /* Tile being rendered, or -1 if it belongs to an earlier frame */
+   size_t i_received;                     /* Bytes of the reply received so far */
+   unsigned char c_reply[REPLY_SIZE];
+} t_worker;
+
+typedef struct {                          /* A window and the frame shown in it */
+   Window x_handle;                       /* X window, or None when writing to a file */
+   int i_screen;                          /* Screen to open the window on, or -1 for the default */
+   int i_left, i_top;                     /* Position of the window */
+   double f_x, f_y;                       /* Coefficients of a julia set, or centre of the view of the mandlebrot set */
+   double f_zoom;                         /* Magnification */
+   t_view x_frame;                        /* What the stored frame shows */
+   uint16_t *p_count;                     /* Iterations for each pixel */
+   float *p_smooth;                       /* Smoothed iterations for each pixel */
+   unsigned int i_stride;                 /* Pixels from the start of one row to the next */
+   t_tile *p_tiles;                       /* Tiles in the current frame */
+   int i_total, i_remaining;              /* Number of tiles, and number still to be drawn */
+   t_tile x_mirror;                       /* Part of the frame copied from the other half */
+   uint32_t i_frame;                      /* Identifies replies for the current frame */
+   int b_loaded;                          /* Frame was loaded from a file */
+   int b_fullscreen;
+   int b_mapped, b_focus, b_pointer;      /* Window is shown, has the focus, or has the pointer in it */
+   int i_visibility;                      /* VisibilityUnobscured, etc. */
+} t_window;
+
+Display *h_display;                       /* Pointer to X display structure. */
+Window x_root_window;                     /* Root window structure. */
+XEvent x_event;
+Atom wm_state;
+Atom wm_fullscreen;
+
+unsigned int i_screen;                    /* Default screen number */
+unsigned int i_window_width = WIDTH ;     /* Window width in pixels. */
+unsigned int i_window_height = HEIGHT ;   /* Window height in pixels. */
+unsigned int i_window_border = 4 ;        /* Window's border width. */
+unsigned int i_background_colour;         /* Window's background colour. */
+unsigned int i_colour_depth;              /* Window's colour depth. */
+
+int i_window_left, i_window_top;          /* Location of the window's top-left corner - relative to parent window. */
+int i_KeyEventCode;
+
+char *s_display_name = "";                /* Just use the default display. */
+char *s_title = NAME;                     /* Windows title */
+char *s_listen = NULL;                    /* Address to accept workers on */
+char *s_worker = NULL;                    /* Address of coordinator to work for */
+char *s_output = NULL;                    /* Name of image file */
+char *s_save = NULL;                      /* Name of file to save iterations to */
+char *s_load = NULL;                      /* Name of file to load iterations from */
+char *s_crop = NULL;                      /* Part of loaded image to keep */
+
+FILE *h_output = NULL;                    /* Image file */
+long i_header;                            /* Length of image file header */
+
+int b_smooth = False;                     /* Colour using smoothed iterations */
+int b_compress = False;                   /* Compress saved tiles */
+int b_benchmark = False;                  /* Compare kernels and exit */
+int b_symmetry = True;                    /* Mirror symmetric parts of the image */
+unsigned int i_kernel = FLOAT;            /* Kernel to use */
+
+int i_listen = -1;                        /* Socket to accept workers on */
+int i_workers = 0;                        /* Number of connected workers */
+t_worker x_worker[WORKERS];
+
+int i_windows = 0;                        /* Number of windows */
+uint32_t i_frames = 0;                    /* Number of frames started */
+t_window x_window[WINDOWS];
+
+/* Defined by each program */
+
+void v_render_tile(t_view *p_view, t_tile *p_tile, uint16_t *p_count, float *p_smooth); /* Count iterations for each pixel in a tile */
+int b_symmetric(t_view *p_view, t_tile *p_mirror); /* Find the part of the image that can be mirrored */
+void v_mirror(t_window *p_window); /* Copy the mirrored part of the stored frame and draw it */
+void v_view(t_window *p_window, t_view *p_view, unsigned int i_width, unsigned int i_height); /* Work out what to draw in a window */
+
+static void v_version() /* Display version information */
+{
+   fprintf(stdout, "%s: Version %s", NAME, VERSION);
+   if (__DATE__[4] == ' ') fprintf(stdout, " 0"); else fprintf(stdout, " %c", __DATE__[4]);
+   fprintf(stdout, "%c %c%c%c %s %s", __DATE__[5],
+      __DATE__[0], __DATE__[1], __DATE__[2], &__DATE__[9], __TIME__ );
+   fprintf(stdout, " (Build: %s)\n", BUILD );
+}
+
+static void v_about() /* Display help text */
+{
+   fprintf(stdout, "Usage: %s [OPTION]...\n", NAME);
+   fprintf(stdout, "Display Mandlebrot or Juila set.\n\n");
+   fprintf(stdout, "  -c, --smooth             colour using smoothed iterations\n");
+   fprintf(stdout, "      --compress           compress tiles in saved files\n");
+   fprintf(stdout, "      --crop=WxH+X+Y       only keep part of the image loaded from a file\n");
+   fprintf(stdout, "  -b, --benchmark          compare the speed and accuracy of each kernel\n");
+   fprintf(stdout, "  -f, --fullscreen         display in fullscreen window\n");
+   fprintf(stdout, "      --geometry=WxH       image size in pixels when writing to a file\n");
+   fprintf(stdout, "      --kernel=NAME        iterate using 'float', 'fixed32' or 'fixed64'\n");
+#if defined(SOCKETS)
+   fprintf(stdout, "      --listen=ADDRESS     hand out tiles to workers connecting to ADDRESS\n");
+#endif
+   fprintf(stdout, "      --load=FILE          display iterations saved in FILE\n");
+   fprintf(stdout, "      --no-symmetry        calculate every pixel even if the image is symmetric\n");
+   fprintf(stdout, "      --output=FILE        write image to FILE (PPM) instead of a window\n");
+   fprintf(stdout, "      --save=FILE          save iterations to FILE instead of a window\n");
+   fprintf(stdout, "      --window=VIEW        open a window showing VIEW (may be repeated)\n");
+#if defined(SOCKETS)
+   fprintf(stdout, "      --worker=ADDRESS     render tiles for the coordinator at ADDRESS\n");
+#endif
+   fprintf(stdout, "  -?, --help               display this help and exit\n");
+   fprintf(stdout, "      --version            output version information and exit\n\n");
+#if defined(SOCKETS)
+   fprintf(stdout, "ADDRESS is either 'unix:PATH' or '[HOST:]PORT' (HOST defaults to this host only).\n");
+#endif
+   fprintf(stdout, "VIEW is %s.\n", VIEW);
+   exit(0);
+}
+
+static void v_error(const char *s_format, ...) /* Print formatted error message and exit */
+{
+   va_list t_args;
+   va_start(t_args, s_format);
+   fprintf(stderr, "%s : ", NAME);
+   vfprintf(stderr, s_format, t_args);
+   va_end(t_args);
+   exit(-1);
+}
+
+static void v_fullscreen(t_window *p_window, int i_state)
+{
+   XEvent x_event;
+   Atom wm_fullscreen;
+
+   x_event.type = ClientMessage;
+   x_event.xclient.window = p_window->x_handle;
+   x_event.xclient.message_type = XInternAtom(h_display, "_NET_WM_STATE", False);
+   x_event.xclient.format = 32;
+   x_event.xclient.data.l[0] = i_state;
+   wm_fullscreen = XInternAtom(h_display, "_NET_WM_STATE_FULLSCREEN", False);
+   x_event.xclient.data.l[1] = wm_fullscreen;
+   x_event.xclient.data.l[2] = 0;
+   XSendEvent(h_display, RootWindow(h_display, p_window->i_screen), False, ClientMessage, &x_event);
+}
+
+static uint32_t pack(uint8_t a, uint8_t b, uint8_t c)
+{
+   return((((((uint32_t)a) << 8) + b) << 8) + c);
+}
+
+static uint32_t hsv2rgb(uint8_t h, uint8_t s, uint8_t v)
+{
+   uint16_t i, m;
+   uint8_t r, g, b;
+   uint8_t p, q, t;
+   
+   if (s == 0)
+   {
+      r = v;
+      g = v;
+      b = v;
+      return pack(r, g, b);
+   }
+   
+   i = (uint16_t)h / 43;
+   m = ((uint16_t)h - (i * 43)) * 6; 
+   
+   p = ((uint16_t)v * (255 - (uint16_t)s)) >> 8;
+   q = ((uint16_t)v * (255 - (((uint16_t)s * m) >> 8))) >> 8;
+   t = ((uint16_t)v * (255 - (((uint16_t)s * (255 - m)) >> 8))) >> 8;
+   
+   switch (i)
+   {
+      case 0:
+         r = v; g = t; b = p;
+         break;
+      case 1:
+         r = q; g = v; b = p;
+         break;
+      case 2:
+         r = p; g = v; b = t;
+         break;
+      case 3:
+         r = p; g = q; b = v;
+         break;
+      case 4:
+         r = t; g = p; b = v;
+         break;
+      default:
+         r = v; g = p; b = q;
+         break;
+   }
+   return pack(r, g, b);
+}
+
+static uint32_t pack_float(float f) /* Get the bits of a float (assumes IEEE floats at both ends) */
+{
+   uint32_t i;
+   memcpy(&i, &f, sizeof(i));
+   return i;
+}
+
+static float unpack_float(uint32_t i)
+{
+   float f;
+   memcpy(&f, &i, sizeof(f));
+   return f;
+}
+
+static uint64_t pack_double(double f) /* Get the bits of a double (assumes IEEE doubles at both ends) */
+{
+   uint64_t i;
+   memcpy(&i, &f, sizeof(i));
+   return i;
+}
+
+static double unpack_double(uint64_t i)
+{
+   double f;
+   memcpy(&f, &i, sizeof(f));
+   return f;
+}
+
+static long i_clock() /* Elapsed time in milliseconds */
+{
+   struct timeval t_time;
+   gettimeofday(&t_time, NULL);
+   return (long)t_time.tv_sec * 1000 + t_time.tv_usec / 1000;
+}
+
+static int64_t i_fixed(double f, int i_bits) /* Convert to fixed point, rounding to nearest */
+{
+   return (int64_t)floor(f * ldexp(1.0, i_bits) + 0.5);
+}
+
+/* Each step starts from a point inside the escape radius, so the next one
+   is at most 4 + |c| from the origin and a view within half of the range
+   of a fixed point format cannot overflow it. */
+
+static int b_in_range(t_view *p_view, unsigned int i_kernel) /* Check that a kernel can be used for a view */
+{
+   double f_range = (i_kernel == FIXED32) ? RANGE32 : RANGE64;
+
+   if (i_kernel == FLOAT) return True;
+   return (fabs(p_view->f_xmin) <= f_range && fabs(p_view->f_xmax) <= f_range &&
+      fabs(p_view->f_ymin) <= f_range && fabs(p_view->f_ymax) <= f_range &&
+      fabs(p_view->cr) <= f_range && fabs(p_view->ci) <= f_range);
+}
+
+static int64_t i_shift(int64_t i_value, int i_bits) /* Shift right rounding down, the same on every host */
+{
+   int64_t i_sign = -(int64_t)(i_value < 0); /* All ones if negative */
+
+   return ((i_value ^ i_sign) >> i_bits) ^ i_sign; /* Only ever shift a positive value */
+}
+
+static int64_t i_mul64(int64_t a, int64_t b) /* Multiply two Q7.56 numbers using only 32 bit products */
+{
+   uint64_t ua = a, ub = b;
+   uint64_t p00 = (ua & 0xffffffff) * (ub & 0xffffffff);
+   uint64_t p01 = (ua & 0xffffffff) * (ub >> 32);
+   uint64_t p10 = (ua >> 32) * (ub & 0xffffffff);
+   uint64_t p11 = (ua >> 32) * (ub >> 32);
+   uint64_t i_mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+   uint64_t i_low = (i_mid << 32) | (p00 & 0xffffffff);
+   uint64_t i_high = p11 + (p01 >> 32) + (p10 >> 32) + (i_mid >> 32);
+
+   i_high -= ub & -(uint64_t)(a < 0); /* Correct the unsigned product for the signs */
+   i_high -= ua & -(uint64_t)(b < 0);
+   return (int64_t)((i_high << (64 - Q64)) | (i_low >> Q64));
+}
+
+static void v_new_frame(t_window *p_window, t_view *p_view) /* Make room to store the iterations for a new frame */
+{
+   p_window->x_frame = *p_view;
+   p_window->i_stride = p_view->i_width;
+   p_window->p_count = realloc(p_window->p_count, sizeof(uint16_t) * p_view->i_width * p_view->i_height);
+   p_window->p_smooth = realloc(p_window->p_smooth, sizeof(float) * p_view->i_width * p_view->i_height);
+   if (p_window->p_count == NULL || p_window->p_smooth == NULL) v_error("Out of memory\n");
+}
+
+static void v_begin_image(t_window *p_window) /* Start writing a new image file */
+{
+   if (h_output != NULL)
+   {
+      rewind(h_output);
+      fprintf(h_output, "P6\n%u %u\n255\n", p_window->x_frame.i_width, p_window->x_frame.i_height);
+      i_header = ftell(h_output);
+   }
+}
+
+static uint32_t i_colour(uint16_t i_count, float f_smooth, unsigned int i_maxiteration)
+{
+   if (b_smooth)
+   {
+      if (!(f_smooth >= 0)) f_smooth = 0; /* Points that start outside the radius (or NaN) */
+      if (f_smooth > i_maxiteration) f_smooth = i_maxiteration;
+      return hsv2rgb(255 * (f_smooth / i_maxiteration), 255, 128);
+   }
+   if (i_count > i_maxiteration) i_count = i_maxiteration;
+   return hsv2rgb(255 * ((float)i_count / i_maxiteration) , 255, 128);
+}
+
+static void v_draw_tile(t_window *p_window, t_tile *p_tile) /* Draw a stored tile in the window or write it to the image file */
+{
+   t_view *p_frame = &p_window->x_frame;
+   GC x_gc = NULL;
+   unsigned int x, y;
+   unsigned long i_pixel;
+   uint32_t i_rgb;
+
+   if (h_output == NULL && p_window->x_handle == None) return; /* Nowhere to draw it */
+   if (p_window->x_handle != None) x_gc = DefaultGC(h_display, p_window->i_screen);
+   for (y = p_tile->i_top; y < p_tile->i_top + p_tile->i_height; y++)
+   {
+      i_pixel = (unsigned long)y * p_window->i_stride + p_tile->i_left;
+      if (h_output != NULL) /* Rows may arrive in any order so seek to the start of each one */
+         fseek(h_output, i_header + ((long)y * p_frame->i_width + p_tile->i_left) * 3, SEEK_SET);
+      for (x = p_tile->i_left; x < p_tile->i_left + p_tile->i_width; x++)
+      {
+         i_rgb = i_colour(p_window->p_count[i_pixel], p_window->p_smooth[i_pixel], p_frame->i_maxiteration);
+         if (h_output != NULL)
+         {
+            if (p_window->p_count[i_pixel] == p_frame->i_maxiteration) i_rgb = 0;
+            fputc((i_rgb >> 16) & 0xff, h_output);
+            fputc((i_rgb >> 8) & 0xff, h_output);
+            fputc(i_rgb & 0xff, h_output);
+         }
+         else
+         {
+            if (p_window->p_count[i_pixel] == p_frame->i_maxiteration)
+               XSetForeground(h_display, x_gc, BlackPixel(h_display, p_window->i_screen));
+            else
+               XSetForeground(h_display, x_gc, i_rgb);
+            XDrawPoint(h_display, p_window->x_handle, x_gc, x, y);
+         }
+         i_pixel++;
+      }
+   }
+   if (h_output != NULL)
+      fflush(h_output);
+   else
+      XFlush(h_display);
+}
+
+static void v_store_tile(t_window *p_window, t_tile *p_tile, uint16_t *p_count, float *p_smooth) /* Copy the iterations for a tile into the stored frame */
+{
+   unsigned int y;
+   unsigned long i_pixel;
+
+   for (y = p_tile->i_top; y < p_tile->i_top + p_tile->i_height; y++)
+   {
+      i_pixel = (unsigned long)y * p_window->i_stride + p_tile->i_left;
+      memcpy(&p_window->p_count[i_pixel], p_count, sizeof(uint16_t) * p_tile->i_width);
+      memcpy(&p_window->p_smooth[i_pixel], p_smooth, sizeof(float) * p_tile->i_width);
+      p_count += p_tile->i_width;
+      p_smooth += p_tile->i_width;
+   }
+}
+
+static int i_split(unsigned int i_left, unsigned int i_top, unsigned int i_width, unsigned int i_height, t_tile *p_tiles)
+{
+   unsigned int x, y;
+   int i_count = 0;
+
+   for (y = i_top; y < i_top + i_height; y += TILE)
+   {
+      for (x = i_left; x < i_left + i_width; x += TILE)
+      {
+         if (p_tiles != NULL) /* Just count them if there is nowhere to put them */
+         {
+            p_tiles[i_count].i_left = x;
+            p_tiles[i_count].i_top = y;
+            p_tiles[i_count].i_width = (i_left + i_width - x < TILE) ? i_left + i_width - x : TILE;
+            p_tiles[i_count].i_height = (i_top + i_height - y < TILE) ? i_top + i_height - y : TILE;
+            p_tiles[i_count].b_done = False;
+            p_tiles[i_count].i_copies = 0;
+         }
+         i_count++;
+      }
+   }
+   return i_count;
+}
+
+static int i_tiles(t_view *p_view, t_tile **p_tiles, t_tile *p_mirror) /* Split the image into tiles, leaving out any mirrored part */
+{
+   unsigned int i_width = p_view->i_width, i_height = p_view->i_height;
+   unsigned int i_left, i_top, i_right, i_bottom;
+   int i_pass, i_count = 0;
+
+   if (p_mirror == NULL || p_mirror->i_width == 0 || p_mirror->i_height == 0)
+   {
+      if ((*p_tiles = malloc(sizeof(t_tile) * i_split(0, 0, i_width, i_height, NULL))) == NULL) v_error("Out of memory\n");
+      return i_split(0, 0, i_width, i_height, *p_tiles);
+   }
+
+   i_left = p_mirror->i_left;
+   i_top = p_mirror->i_top;
+   i_right = p_mirror->i_left + p_mirror->i_width;
+   i_bottom = p_mirror->i_top + p_mirror->i_height;
+   *p_tiles = NULL;
+   for (i_pass = 0; i_pass < 2; i_pass++) /* Count the tiles, then fill them in */
+   {
+      i_count = i_split(0, 0, i_width, i_top, *p_tiles);
+      i_count += i_split(0, i_top, i_left, i_bottom - i_top, *p_tiles ? *p_tiles + i_count : NULL);
+      i_count += i_split(i_right, i_top, i_width - i_right, i_bottom - i_top, *p_tiles ? *p_tiles + i_count : NULL);
+      i_count += i_split(0, i_bottom, i_width, i_height - i_bottom, *p_tiles ? *p_tiles + i_count : NULL);
+      if (*p_tiles == NULL && (*p_tiles = malloc(sizeof(t_tile) * (i_count + 1))) == NULL) v_error("Out of memory\n");
+   }
+   return i_count;
+}
+
+static long i_axis(double f_min, double f_max, unsigned int i_size) /* Find k such that pixel i and pixel k - i are either side of zero, or -1 */
+{
+   double f_axis = -2.0 * f_min * i_size / (f_max - f_min);
+   double f_nearest = floor(f_axis + 0.5);
+
+   if (fabs(f_axis - f_nearest) > 0.001 || f_nearest <= 0 || f_nearest >= 2.0 * (i_size - 1))
+      return -1; /* Pixels don't line up or nothing overlaps */
+   return (long)f_nearest;
+}
+
+static void v_redraw(t_window *p_window) /* Draw the stored frame again without recalculating it */
+{
+   t_tile *p_tiles;
+   int i_total, i_tile;
+
+   if (p_window->p_count == NULL) return; /* Nothing to draw yet */
+   if (p_window->i_remaining > 0) /* Only draw the tiles that have been calculated so far */
+   {
+      for (i_tile = 0; i_tile < p_window->i_total; i_tile++)
+         if (p_window->p_tiles[i_tile].b_done) v_draw_tile(p_window, &p_window->p_tiles[i_tile]);
+      return;
+   }
+   v_begin_image(p_window);
+   i_total = i_tiles(&p_window->x_frame, &p_tiles, NULL);
+   for (i_tile = 0; i_tile < i_total; i_tile++)
+      v_draw_tile(p_window, &p_tiles[i_tile]);
+   free(p_tiles);
+}
+
+static void v_put32(FILE *h_file, uint32_t i_value) /* Write a word to a file in network byte order */
+{
+   fputc((i_value >> 24) & 0xff, h_file);
+   fputc((i_value >> 16) & 0xff, h_file);
+   fputc((i_value >> 8) & 0xff, h_file);
+   fputc(i_value & 0xff, h_file);
+}
+
+static void v_put64(FILE *h_file, uint64_t i_value) /* Write a double word to a file, most significant word first */
+{
+   v_put32(h_file, i_value >> 32);
+   v_put32(h_file, i_value & 0xffffffff);
+}
+
+static uint32_t i_get32(unsigned char *p_data) /* Read a word in network byte order from memory */
+{
+   return ((uint32_t)p_data[0] << 24) | ((uint32_t)p_data[1] << 16) | ((uint32_t)p_data[2] << 8) | p_data[3];
+}
+
+static uint64_t i_get64(unsigned char *p_data) /* Read a double word from memory, most significant word first */
+{
+   return ((uint64_t)i_get32(p_data) << 32) | i_get32(p_data + 4);
+}
+
+#if defined(SOCKETS)
+static void v_set32(unsigned char *p_data, uint32_t i_value) /* Store a word in network byte order in memory */
+{
+   p_data[0] = (i_value >> 24) & 0xff;
+   p_data[1] = (i_value >> 16) & 0xff;
+   p_data[2] = (i_value >> 8) & 0xff;
+   p_data[3] = i_value & 0xff;
+}
+#endif
+
+/* The saved file starts with a header of HEADER words giving the view,
+   the kernel that calculated it and how the frame is stored.  The header
+   is in network byte order, apart from one word that holds ORDER in the
+   byte order of the host that saved the file.
+
+   An uncompressed FRAME holds the iterations for every pixel (padded to a
+   whole word) followed by the smoothed iterations for every pixel, in the
+   byte order of the host that saved it, so a host with the same byte order
+   can use them straight from the mapped file without copying them.
+
+   A compressed frame is stored as TILES, with an offset, length and
+   encoding for each tile followed by the tiles, all in network byte order.
+   A RAW tile holds the iterations for each pixel (padded to a whole word)
+   followed by the smoothed iterations for each pixel.  An RLE tile holds a
+   word with the length and iterations for each run of identical pixels,
+   followed by the smoothed iterations for each pixel that escaped (those
+   that did not are always the same).  Each tile is saved using whichever
+   is smaller.  */
+
+static void v_save_tiles(FILE *h_file, t_window *p_window) /* Write the stored frame as separately encoded tiles */
+{
+   t_view *p_frame = &p_window->x_frame;
+   uint16_t *p_count = p_window->p_count;
+   float *p_smooth = p_window->p_smooth;
+   t_tile *p_tiles;
+   unsigned long *p_runs;
+   unsigned long i_offset, i_pixel, i_length, i_escaped;
+   unsigned int x, y, i_run;
+   int i_total, i_tile;
+
+   i_total = i_tiles(p_frame, &p_tiles, NULL);
+   if ((p_runs = malloc(sizeof(unsigned long) * i_total)) == NULL) v_error("Out of memory\n");
+
+   i_offset = (HEADER + 3 * (unsigned long)i_total) * 4;
+   for (i_tile = 0; i_tile < i_total; i_tile++) /* Work out how to store each tile */
+   {
+      p_runs[i_tile] = 0;
+      i_escaped = 0;
+      for (y = p_tiles[i_tile].i_top; y < p_tiles[i_tile].i_top + p_tiles[i_tile].i_height; y++)
+      {
+         i_pixel = (unsigned long)y * p_window->i_stride + p_tiles[i_tile].i_left;
+         for (x = 0; x < p_tiles[i_tile].i_width; x++, i_pixel++) /* Runs never span rows */
+         {
+            if (x == 0 || p_count[i_pixel] != p_count[i_pixel - 1]) p_runs[i_tile]++;
+            if (p_count[i_pixel] != p_frame->i_maxiteration) i_escaped++;
+         }
+      }
+      i_length = p_tiles[i_tile].i_width * p_tiles[i_tile].i_height;
+      i_length = ((i_length + 1) / 2) * 4 + i_length * 4;
+      if ((p_runs[i_tile] + i_escaped) * 4 < i_length)
+         i_length = (p_runs[i_tile] + i_escaped) * 4;
+      else
+         p_runs[i_tile] = 0; /* Not worth compressing */
+      v_put32(h_file, i_offset);
+      v_put32(h_file, i_length);
+      v_put32(h_file, p_runs[i_tile] ? RLE : RAW);
+      i_offset += i_length;
+   }
+
+   for (i_tile = 0; i_tile < i_total; i_tile++)
+   {
+      i_length = 0;
+      for (y = p_tiles[i_tile].i_top; y < p_tiles[i_tile].i_top + p_tiles[i_tile].i_height; y++)
+      {
+         i_pixel = (unsigned long)y * p_window->i_stride + p_tiles[i_tile].i_left;
+         for (x = 0; x < p_tiles[i_tile].i_width; x += i_run)
+         {
+            if (p_runs[i_tile])
+               for (i_run = 1; x + i_run < p_tiles[i_tile].i_width &&
+                  p_count[i_pixel + i_run] == p_count[i_pixel]; i_run++);
+            else
+               i_run = 1;
+            if (p_runs[i_tile])
+               v_put32(h_file, (i_run << 16) | p_count[i_pixel]);
+            else
+            {
+               fputc(p_count[i_pixel] >> 8, h_file);
+               fputc(p_count[i_pixel] & 0xff, h_file);
+            }
+            i_pixel += i_run;
+            i_length++;
+         }
+      }
+      if (!p_runs[i_tile] && (i_length & 1)) /* Pad to a whole word */
+      {
+         fputc(0, h_file);
+         fputc(0, h_file);
+      }
+      for (y = p_tiles[i_tile].i_top; y < p_tiles[i_tile].i_top + p_tiles[i_tile].i_height; y++)
+      {
+         i_pixel = (unsigned long)y * p_window->i_stride + p_tiles[i_tile].i_left;
+         for (x = 0; x < p_tiles[i_tile].i_width; x++, i_pixel++)
+            if (!p_runs[i_tile] || p_count[i_pixel] != p_frame->i_maxiteration)
+               v_put32(h_file, pack_float(p_smooth[i_pixel]));
+      }
+   }
+   free(p_runs);
+   free(p_tiles);
+}
+
+static void v_save(t_window *p_window, char *s_name) /* Save the stored frame */
+{
+   t_view *p_frame = &p_window->x_frame;
+   uint32_t i_order = ORDER;
+   FILE *h_file;
+   char *s_temp;
+   unsigned int y;
+
+   /* The frame may still be mapped from the file being replaced, so write
+      a new file and only rename it once it is complete. */
+
+   if ((s_temp = malloc(strlen(s_name) + 5)) == NULL) v_error("Out of memory\n");
+   sprintf(s_temp, "%s.tmp", s_name);
+   if ((h_file = fopen(s_temp, "wb")) == NULL) v_error("Cannot open '%s'\n", s_temp);
+
+   v_put32(h_file, FORMAT);
+   v_put32(h_file, TILE);
+   v_put32(h_file, p_frame->i_width);
+   v_put32(h_file, p_frame->i_height);
+   v_put32(h_file, p_frame->i_maxiteration);
+   v_put32(h_file, p_frame->i_kernel);
+   v_put32(h_file, b_compress ? TILES : FRAME);
+   fwrite(&i_order, sizeof(i_order), 1, h_file); /* In this host's byte order */
+   v_put64(h_file, pack_double(p_frame->f_xmin));
+   v_put64(h_file, pack_double(p_frame->f_xmax));
+   v_put64(h_file, pack_double(p_frame->f_ymin));
+   v_put64(h_file, pack_double(p_frame->f_ymax));
+   v_put64(h_file, pack_double(p_frame->cr));
+   v_put64(h_file, pack_double(p_frame->ci));
+   v_put32(h_file, b_compress ? i_split(0, 0, p_frame->i_width, p_frame->i_height, NULL) : 0); /* Number of tiles */
+   v_put32(h_file, b_compress ? 0 : HEADER * 4); /* Start of the frame */
+
+   if (b_compress)
+      v_save_tiles(h_file, p_window);
+   else
+   {
+      for (y = 0; y < p_frame->i_height; y++)
+         fwrite(&p_window->p_count[(unsigned long)y * p_window->i_stride], sizeof(uint16_t), p_frame->i_width, h_file);
+      if (((unsigned long)p_frame->i_width * p_frame->i_height) & 1) /* Pad to a whole word */
+      {
+         fputc(0, h_file);
+         fputc(0, h_file);
+      }
+      for (y = 0; y < p_frame->i_height; y++)
+         fwrite(&p_window->p_smooth[(unsigned long)y * p_window->i_stride], sizeof(float), p_frame->i_width, h_file);
+   }
+   if (ferror(h_file) | fclose(h_file)) v_error("Cannot write '%s'\n", s_temp);
+   if (rename(s_temp, s_name) < 0) v_error("Cannot write '%s'\n", s_name);
+   free(s_temp);
+}
+
+static void v_load_tiles(t_window *p_window, t_view *p_view, unsigned char *p_data, unsigned long i_size, char *s_name) /* Decode a frame stored as tiles */
+{
+   unsigned char *p_next, *p_end;
+   t_tile *p_tiles;
+   uint16_t i_count[TILE * TILE];
+   float f_smooth[TILE * TILE];
+   unsigned long i_offset, i_length;
+   unsigned int i_pixels, i_index, i_run;
+   int i_total, i_tile;
+
+   v_new_frame(p_window, p_view);
+   i_total = i_tiles(p_view, &p_tiles, NULL);
+   if (i_get32(p_data + 80) != i_total || i_size < (HEADER + 3 * (unsigned long)i_total) * 4)
+      v_error("'%s' is corrupt\n", s_name);
+
+   for (i_tile = 0; i_tile < i_total; i_tile++)
+   {
+      i_offset = i_get32(p_data + (HEADER + 3 * i_tile) * 4);
+      i_length = i_get32(p_data + (HEADER + 3 * i_tile) * 4 + 4);
+      i_pixels = p_tiles[i_tile].i_width * p_tiles[i_tile].i_height;
+      if (i_offset > i_size || i_length > i_size - i_offset)
+         v_error("'%s' is corrupt\n", s_name);
+      p_next = p_data + i_offset;
+      p_end = p_next + i_length;
+
+      switch (i_get32(p_data + (HEADER + 3 * i_tile) * 4 + 8))
+      {
+      case RAW:
+         if (i_length != ((i_pixels + 1) / 2) * 4 + i_pixels * 4) v_error("'%s' is corrupt\n", s_name);
+         for (i_index = 0; i_index < i_pixels; i_index++)
+            i_count[i_index] = (p_next[2 * i_index] << 8) | p_next[2 * i_index + 1];
+         p_next += ((i_pixels + 1) / 2) * 4;
+         for (i_index = 0; i_index < i_pixels; i_index++)
+            f_smooth[i_index] = unpack_float(i_get32(p_next + 4 * i_index));
+         break;
+      case RLE:
+         for (i_index = 0; i_index < i_pixels; p_next += 4)
+         {
+            if (p_next + 4 > p_end) v_error("'%s' is corrupt\n", s_name);
+            i_run = i_get32(p_next) >> 16;
+            if (i_run == 0 || i_index + i_run > i_pixels) v_error("'%s' is corrupt\n", s_name);
+            while (i_run--) i_count[i_index++] = i_get32(p_next) & 0xffff;
+         }
+         for (i_index = 0; i_index < i_pixels; i_index++)
+         {
+            if (i_count[i_index] == p_view->i_maxiteration)
+               f_smooth[i_index] = p_view->i_maxiteration;
+            else
+            {
+               if (p_next + 4 > p_end) v_error("'%s' is corrupt\n", s_name);
+               f_smooth[i_index] = unpack_float(i_get32(p_next));
+               p_next += 4;
+            }
+         }
+         if (p_next != p_end) v_error("'%s' is corrupt\n", s_name);
+         break;
+      default:
+         v_error("'%s' is corrupt\n", s_name);
+      }
+      v_store_tile(p_window, &p_tiles[i_tile], i_count, f_smooth);
+   }
+   free(p_tiles);
+}
+
+static unsigned char *p_map_file(char *s_name, unsigned long *p_size) /* Map a file into memory, or read it if it can't be mapped */
+{
+   unsigned char *p_data;
+#if defined(MMAP)
+   struct stat t_stat;
+   int i_file;
+
+   if ((i_file = open(s_name, O_RDONLY)) < 0 || fstat(i_file, &t_stat) < 0)
+      v_error("Cannot open '%s'\n", s_name);
+   *p_size = t_stat.st_size;
+   if (*p_size < HEADER * 4 || (p_data = mmap(NULL, *p_size, PROT_READ, MAP_SHARED, i_file, 0)) == MAP_FAILED)
+      v_error("Cannot read '%s'\n", s_name);
+   close(i_file);
+#else
+   FILE *h_file;
+   long i_size;
+
+   if ((h_file = fopen(s_name, "rb")) == NULL) v_error("Cannot open '%s'\n", s_name);
+   if (fseek(h_file, 0, SEEK_END) != 0 || (i_size = ftell(h_file)) < HEADER * 4 || fseek(h_file, 0, SEEK_SET) != 0)
+      v_error("Cannot read '%s'\n", s_name);
+   if ((p_data = malloc(i_size)) == NULL) v_error("Out of memory\n");
+   if (fread(p_data, 1, i_size, h_file) != (size_t)i_size) v_error("Cannot read '%s'\n", s_name);
+   fclose(h_file);
+   *p_size = i_size;
+#endif
+   return p_data;
+}
+
+static void v_unmap_file(unsigned char *p_data, unsigned long i_size) /* Release a file that is no longer needed */
+{
+#if defined(MMAP)
+   munmap(p_data, i_size);
+#else
+   free(p_data);
+#endif
+}
+
+static void v_load(t_window *p_window, char *s_name) /* Load a saved frame, using it in place if possible */
+{
+   unsigned char *p_data, *p_frame;
+   t_view x_view;
+   uint32_t i_order, i_smooth;
+   uint16_t i_count;
+   unsigned long i_size, i_offset, i_pixels, i_index;
+
+   p_data = p_map_file(s_name, &i_size);
+
+   if (i_get32(p_data) != FORMAT || i_get32(p_data + 4) != TILE)
+      v_error("'%s' is not a %s file\n", s_name, NAME);
+   x_view.i_width = i_get32(p_data + 8);
+   x_view.i_height = i_get32(p_data + 12);
+   x_view.i_maxiteration = i_get32(p_data + 16);
+   x_view.i_kernel = i_get32(p_data + 20);
+   x_view.b_smooth = True;                /* Saved with the smoothed iterations */
+   memcpy(&i_order, p_data + 28, sizeof(i_order));
+   x_view.f_xmin = unpack_double(i_get64(p_data + 32));
+   x_view.f_xmax = unpack_double(i_get64(p_data + 40));
+   x_view.f_ymin = unpack_double(i_get64(p_data + 48));
+   x_view.f_ymax = unpack_double(i_get64(p_data + 56));
+   x_view.cr = unpack_double(i_get64(p_data + 64));
+   x_view.ci = unpack_double(i_get64(p_data + 72));
+   if (x_view.i_width == 0 || x_view.i_height == 0 || x_view.i_maxiteration == 0 || x_view.i_maxiteration > 0xffff ||
+      x_view.i_width > 0xffff || x_view.i_height > 0xffff || x_view.i_kernel > FIXED64)
+      v_error("'%s' is corrupt\n", s_name);
+
+   switch (i_get32(p_data + 24))
+   {
+   case FRAME:
+      i_pixels = (unsigned long)x_view.i_width * x_view.i_height;
+      i_offset = i_get32(p_data + 84);
+      if (i_offset < HEADER * 4 || i_offset % 4 != 0 || i_offset > i_size ||
+         i_size - i_offset != ((i_pixels + 1) / 2) * 4 + i_pixels * 4 ||
+         (i_order != ORDER && i_order != 0x04030201))
+         v_error("'%s' is corrupt\n", s_name);
+      p_frame = p_data + i_offset;
+      if (i_order == ORDER) /* Use the frame where it is, keeping the file in memory */
+      {
+         p_window->x_frame = x_view;
+         p_window->i_stride = x_view.i_width;
+         p_window->p_count = (uint16_t *)p_frame;
+         p_window->p_smooth = (float *)(p_frame + ((i_pixels + 1) / 2) * 4);
+         p_window->b_loaded = True;
+         return;
+      }
+      v_new_frame(p_window, &x_view); /* Saved by a host with the other byte order, so swap each value */
+      for (i_index = 0; i_index < i_pixels; i_index++)
+      {
+         memcpy(&i_count, p_frame + 2 * i_index, sizeof(i_count));
+         p_window->p_count[i_index] = (uint16_t)((i_count >> 8) | (i_count << 8));
+         memcpy(&i_smooth, p_frame + ((i_pixels + 1) / 2) * 4 + 4 * i_index, sizeof(i_smooth));
+         i_smooth = (i_smooth >> 24) | ((i_smooth >> 8) & 0xff00) | ((i_smooth << 8) & 0xff0000) | (i_smooth << 24);
+         p_window->p_smooth[i_index] = unpack_float(i_smooth);
+      }
+      break;
+   case TILES:
+      v_load_tiles(p_window, &x_view, p_data, i_size, s_name);
+      break;
+   default:
+      v_error("'%s' is corrupt\n", s_name);
+   }
+   v_unmap_file(p_data, i_size);
+   p_window->b_loaded = True;
+}
+
+static void v_crop(t_window *p_window, char *s_geometry) /* Keep only part of a loaded frame */
+{
+   t_view *p_frame = &p_window->x_frame;
+   unsigned int i_width, i_height, i_left, i_top;
+   double f_xdelta, f_ydelta;
+
+   if (sscanf(s_geometry, "%ux%u+%u+%u", &i_width, &i_height, &i_left, &i_top) != 4 ||
+      i_width == 0 || i_height == 0 ||
+      i_left >= p_frame->i_width || i_width > p_frame->i_width - i_left ||
+      i_top >= p_frame->i_height || i_height > p_frame->i_height - i_top)
+      v_error("invalid crop %s\n", s_geometry);
+
+   /* A loaded frame is never freed or reallocated, so rather than copying
+      the part to keep just start from its top left corner and leave the
+      stride as it was. */
+
+   p_window->p_count += (unsigned long)i_top * p_window->i_stride + i_left;
+   p_window->p_smooth += (unsigned long)i_top * p_window->i_stride + i_left;
+
+   f_xdelta = (p_frame->f_xmin - p_frame->f_xmax) / p_frame->i_width; /* Move the edges to match */
+   f_ydelta = (p_frame->f_ymin - p_frame->f_ymax) / p_frame->i_height;
+   p_frame->f_xmax = p_frame->f_xmin - (i_left + i_width) * f_xdelta;
+   p_frame->f_xmin = p_frame->f_xmin - i_left * f_xdelta;
+   p_frame->f_ymax = p_frame->f_ymin - (i_top + i_height) * f_ydelta;
+   p_frame->f_ymin = p_frame->f_ymin - i_top * f_ydelta;
+   p_frame->i_width = i_width;
+   p_frame->i_height = i_height;
+}
+
+#if defined(SOCKETS)
+static void v_close_socket(char *s_address, int i_socket) /* Close a listening socket, removing it if it is a local one */
+{
+   close(i_socket);
+   if (!strncmp(s_address, "unix:", 5)) unlink(s_address + 5);
+}
+
+static int i_open_socket(char *s_address, int b_listen) /* Listen on or connect to 'unix:PATH' or '[HOST:]PORT' */
+{
+   struct sockaddr_un x_unix;
+   struct addrinfo x_hints, *p_info, *p_addr;
+   struct stat t_stat;
+   char s_host[256];
+   char *s_name, *s_port;
+   int i_socket = -1;
+   int i_option = 1;
+
+   if (b_listen) signal(SIGPIPE, SIG_IGN); /* Notice workers that have gone away when writing to them */
+
+   if (!strncmp(s_address, "unix:", 5))
+   {
+      memset(&x_unix, 0, sizeof(x_unix));
+      x_unix.sun_family = AF_UNIX;
+      strncpy(x_unix.sun_path, s_address + 5, sizeof(x_unix.sun_path) - 1);
+      if ((i_socket = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) return -1;
+      if (b_listen)
+      {
+         if (lstat(x_unix.sun_path, &t_stat) == 0) /* Only remove a stale socket, never anything else */
+         {
+            if (!S_ISSOCK(t_stat.st_mode)) v_error("'%s' is not a socket\n", x_unix.sun_path);
+            unlink(x_unix.sun_path);
+         }
+         if (bind(i_socket, (struct sockaddr *)&x_unix, sizeof(x_unix)) == 0 && listen(i_socket, WORKERS) == 0)
+            return i_socket;
+      }
+      else if (connect(i_socket, (struct sockaddr *)&x_unix, sizeof(x_unix)) == 0)
+         return i_socket;
+      close(i_socket);
+      return -1;
+   }
+
+   strncpy(s_host, s_address, sizeof(s_host) - 1);
+   s_host[sizeof(s_host) - 1] = 0;
+   if ((s_port = strrchr(s_host, ':')) != NULL)
+   {
+      *s_port++ = 0;
+      s_name = (s_host[0] != 0) ? s_host : NULL;
+   }
+   else
+   {
+      s_port = s_host;
+      s_name = NULL;
+   }
+
+   memset(&x_hints, 0, sizeof(x_hints));
+   x_hints.ai_family = AF_UNSPEC;
+   x_hints.ai_socktype = SOCK_STREAM;
+   /* Without AI_PASSIVE a missing host gives the loopback address, so only
+      local workers can connect unless a host such as 0.0.0.0 is given. */
+   if (getaddrinfo(s_name, s_port, &x_hints, &p_info) != 0) return -1;
+   for (p_addr = p_info; p_addr != NULL; p_addr = p_addr->ai_next)
+   {
+      if ((i_socket = socket(p_addr->ai_family, p_addr->ai_socktype, p_addr->ai_protocol)) < 0) continue;
+      if (b_listen)
+      {
+         setsockopt(i_socket, SOL_SOCKET, SO_REUSEADDR, &i_option, sizeof(i_option));
+         if (bind(i_socket, p_addr->ai_addr, p_addr->ai_addrlen) == 0 && listen(i_socket, WORKERS) == 0) break;
+      }
+      else if (connect(i_socket, p_addr->ai_addr, p_addr->ai_addrlen) == 0)
+         break;
+      close(i_socket);
+      i_socket = -1;
+   }
+   freeaddrinfo(p_info);
+   return i_socket;
+}
+
+static int i_read(int i_socket, void *p_data, size_t i_size) /* Read exactly i_size bytes */
+{
+   ssize_t i_count;
+   while (i_size > 0)
+   {
+      if ((i_count = read(i_socket, p_data, i_size)) <= 0) return False;
+      p_data = (char *)p_data + i_count;
+      i_size -= i_count;
+   }
+   return True;
+}
+
+static int i_write(int i_socket, void *p_data, size_t i_size) /* Write exactly i_size bytes */
+{
+   ssize_t i_count;
+   while (i_size > 0)
+   {
+      if ((i_count = write(i_socket, p_data, i_size)) <= 0) return False;
+      p_data = (char *)p_data + i_count;
+      i_size -= i_count;
+   }
+   return True;
+}
+
+/* A reply is a header of REPLY words (MAGIC, frame, tile and the number of
+   pixels) followed by the iterations for each pixel as 16 bit values and
+   then the smoothed iterations for each pixel, all in network byte order.
+   It is sent in one go so the coordinator is never left waiting for the
+   rest of a reply from a worker that has stopped part way through. */
+
+static void v_worker(char *s_address) /* Render tiles for a coordinator until it disconnects */
+{
+   t_view x_view;
+   t_tile x_tile;
+   uint32_t i_request[REQUEST];
+   uint16_t i_count[TILE * TILE];
+   float f_smooth[TILE * TILE];
+   unsigned char c_reply[REPLY_SIZE];
+   unsigned int i_index, i_pixels;
+   int i_socket, i_retry;
+
+   for (i_retry = 1; (i_socket = i_open_socket(s_address, False)) < 0; i_retry++)
+   {
+      if (i_retry >= RETRY) v_error("Cannot connect to coordinator '%s'\n", s_address);
+      sleep(1); /* Coordinator may not have started yet */
+   }
+
+   while (i_read(i_socket, i_request, sizeof(i_request)))
+   {
+      for (i_index = 0; i_index < REQUEST; i_index++) i_request[i_index] = ntohl(i_request[i_index]);
+      x_tile.i_left = i_request[3];
+      x_tile.i_top = i_request[4];
+      x_tile.i_width = i_request[5];
+      x_tile.i_height = i_request[6];
+      x_view.i_width = i_request[7];
+      x_view.i_height = i_request[8];
+      x_view.i_maxiteration = i_request[9];
+      x_view.i_kernel = i_request[10];
+      x_view.b_smooth = i_request[23];
+      x_view.f_xmin = unpack_double(((uint64_t)i_request[11] << 32) | i_request[12]);
+      x_view.f_xmax = unpack_double(((uint64_t)i_request[13] << 32) | i_request[14]);
+      x_view.f_ymin = unpack_double(((uint64_t)i_request[15] << 32) | i_request[16]);
+      x_view.f_ymax = unpack_double(((uint64_t)i_request[17] << 32) | i_request[18]);
+      x_view.cr = unpack_double(((uint64_t)i_request[19] << 32) | i_request[20]);
+      x_view.ci = unpack_double(((uint64_t)i_request[21] << 32) | i_request[22]);
+      if (i_request[0] != MAGIC || x_tile.i_width > TILE || x_tile.i_height > TILE || x_view.i_kernel > FIXED64 ||
+         !b_in_range(&x_view, x_view.i_kernel))
+         v_error("Invalid request from coordinator '%s'\n", s_address);
+
+      v_render_tile(&x_view, &x_tile, i_count, f_smooth);
+
+      i_pixels = x_tile.i_width * x_tile.i_height;
+      for (i_index = 0; i_index < 3; i_index++) v_set32(c_reply + 4 * i_index, i_request[i_index]);
+      v_set32(c_reply + 12, i_pixels);
+      for (i_index = 0; i_index < i_pixels; i_index++)
+      {
+         c_reply[REPLY * 4 + 2 * i_index] = i_count[i_index] >> 8;
+         c_reply[REPLY * 4 + 2 * i_index + 1] = i_count[i_index] & 0xff;
+         v_set32(c_reply + REPLY * 4 + 2 * i_pixels + 4 * i_index, pack_float(f_smooth[i_index]));
+      }
+      if (!i_write(i_socket, c_reply, REPLY * 4 + 6 * i_pixels)) break;
+   }
+   close(i_socket);
+   exit(0);
+}
+
+static int i_receive(t_worker *p_worker) /* Read whatever has arrived of a reply, returning 1 once it is complete, 0 if there is more to come or -1 if it is invalid or the worker has gone away */
+{
+   size_t i_size;
+   ssize_t i_count;
+
+   for (;;)
+   {
+      i_size = REPLY * 4;
+      if (p_worker->i_received >= i_size) /* The header gives the size of the rest */
+      {
+         if (i_get32(p_worker->c_reply) != MAGIC || i_get32(p_worker->c_reply + 12) > TILE * TILE) return -1;
+         i_size += 6 * i_get32(p_worker->c_reply + 12);
+      }
+      if (p_worker->i_received == i_size) return 1;
+      if ((i_count = read(p_worker->i_socket, p_worker->c_reply + p_worker->i_received, i_size - p_worker->i_received)) == 0)
+         return -1;
+      if (i_count < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+      p_worker->i_received += i_count;
+   }
+}
+
+static void v_drop_worker(int i_worker) /* Disconnect a worker and release its tile */
+{
+   debug(fprintf(stderr, "Dropping worker %d\n", x_worker[i_worker].i_socket));
+   close(x_worker[i_worker].i_socket);
+   if (x_worker[i_worker].i_tile >= 0)
+      x_window[x_worker[i_worker].i_window].p_tiles[x_worker[i_worker].i_tile].i_copies--;
+   x_worker[i_worker] = x_worker[--i_workers];
+}
+
+static int i_send_tile(t_worker *p_worker, int i_window, int i_tile)
+{
+   t_view *p_view = &x_window[i_window].x_frame;
+   t_tile *p_tiles = x_window[i_window].p_tiles;
+   uint32_t i_request[REQUEST];
+   int i_index;
+
+   i_request[0] = MAGIC;
+   i_request[1] = x_window[i_window].i_frame;
+   i_request[2] = i_tile;
+   i_request[3] = p_tiles[i_tile].i_left;
+   i_request[4] = p_tiles[i_tile].i_top;
+   i_request[5] = p_tiles[i_tile].i_width;
+   i_request[6] = p_tiles[i_tile].i_height;
+   i_request[7] = p_view->i_width;
+   i_request[8] = p_view->i_height;
+   i_request[9] = p_view->i_maxiteration;
+   i_request[10] = p_view->i_kernel;
+   i_request[11] = pack_double(p_view->f_xmin) >> 32;
+   i_request[12] = pack_double(p_view->f_xmin) & 0xffffffff;
+   i_request[13] = pack_double(p_view->f_xmax) >> 32;
+   i_request[14] = pack_double(p_view->f_xmax) & 0xffffffff;
+   i_request[15] = pack_double(p_view->f_ymin) >> 32;
+   i_request[16] = pack_double(p_view->f_ymin) & 0xffffffff;
+   i_request[17] = pack_double(p_view->f_ymax) >> 32;
+   i_request[18] = pack_double(p_view->f_ymax) & 0xffffffff;
+   i_request[19] = pack_double(p_view->cr) >> 32;
+   i_request[20] = pack_double(p_view->cr) & 0xffffffff;
+   i_request[21] = pack_double(p_view->ci) >> 32;
+   i_request[22] = pack_double(p_view->ci) & 0xffffffff;
+   i_request[23] = p_view->b_smooth;
+   for (i_index = 0; i_index < REQUEST; i_index++) i_request[i_index] = htonl(i_request[i_index]);
+   if (!i_write(p_worker->i_socket, i_request, sizeof(i_request))) return False;
+
+   p_worker->b_busy = True;
+   p_worker->i_window = i_window;
+   p_worker->i_tile = i_tile;
+   if (p_tiles[i_tile].i_copies++ == 0) p_tiles[i_tile].i_start = i_clock();
+   return True;
+}
+
+#endif
+
+static int i_priority(t_window *p_window) /* How urgently a window needs its tiles */
+{
+   if (p_window->x_handle == None) return VISIBLE; /* Writing to a file */
+   if (!p_window->b_mapped || p_window->i_visibility == VisibilityFullyObscured) return BACKGROUND;
+   if (p_window->b_focus || p_window->b_pointer) return INTERACTIVE;
+   return VISIBLE;
+}
+
+/* Tiles are taken from the windows in order of priority, so windows being
+   looked at or used are drawn first and windows that can't be seen are only
+   drawn when there is nothing else to do.  If every tile has been handed out
+   and b_copy is set the oldest tile that is taking too long is returned, so
+   it can be given to another worker as well. */
+
+static int b_next_tile(int b_copy, int *p_window, int *p_tile)
+{
+   t_tile *p_tiles;
+   long i_now = i_clock();
+   int i_level, i_index, i_tile;
+
+   for (i_level = INTERACTIVE; i_level <= BACKGROUND; i_level++)
+   {
+      for (i_index = 0; i_index < i_windows; i_index++)
+      {
+         if (x_window[i_index].i_remaining == 0 || i_priority(&x_window[i_index]) != i_level) continue;
+         p_tiles = x_window[i_index].p_tiles;
+         for (i_tile = 0; i_tile < x_window[i_index].i_total; i_tile++)
+         {
+            if (!p_tiles[i_tile].b_done && p_tiles[i_tile].i_copies == 0)
+            {
+               *p_window = i_index;
+               *p_tile = i_tile;
+               return True;
+            }
+         }
+      }
+   }
+   if (!b_copy) return False;
+
+   for (i_level = INTERACTIVE; i_level <= BACKGROUND; i_level++)
+   {
+      *p_tile = -1;
+      for (i_index = 0; i_index < i_windows; i_index++)
+      {
+         if (x_window[i_index].i_remaining == 0 || i_priority(&x_window[i_index]) != i_level) continue;
+         p_tiles = x_window[i_index].p_tiles;
+         for (i_tile = 0; i_tile < x_window[i_index].i_total; i_tile++)
+         {
+            if (!p_tiles[i_tile].b_done && p_tiles[i_tile].i_copies == 1 && i_now - p_tiles[i_tile].i_start > TIMEOUT &&
+               (*p_tile < 0 || p_tiles[i_tile].i_start < x_window[*p_window].p_tiles[*p_tile].i_start))
+            {
+               *p_window = i_index;
+               *p_tile = i_tile;
+            }
+         }
+      }
+      if (*p_tile >= 0) return True;
+   }
+   return False;
+}
+
+static void v_tile_done(t_window *p_window, int i_tile, uint16_t *p_count, float *p_smooth) /* Store and draw a calculated tile */
+{
+   v_store_tile(p_window, &p_window->p_tiles[i_tile], p_count, p_smooth);
+   v_draw_tile(p_window, &p_window->p_tiles[i_tile]);
+   p_window->p_tiles[i_tile].b_done = True;
+   if (--p_window->i_remaining == 0) v_mirror(p_window);
+}
+
+static int b_render_local() /* Calculate the next tile, returning False if there is nothing to do */
+{
+   uint16_t i_count[TILE * TILE];
+   float f_smooth[TILE * TILE];
+   int i_window, i_tile;
+
+   if (!b_next_tile(False, &i_window, &i_tile)) return False;
+   v_render_tile(&x_window[i_window].x_frame, &x_window[i_window].p_tiles[i_tile], i_count, f_smooth);
+   v_tile_done(&x_window[i_window], i_tile, i_count, f_smooth);
+   return True;
+}
+
+#if defined(SOCKETS)
+static void v_serve_workers() /* Hand out tiles to workers and draw the results, returning when there is an event to handle */
+{
+   uint16_t i_count[TILE * TILE];
+   float f_smooth[TILE * TILE];
+   unsigned char *p_reply;
+   t_tile *p_tile;
+   struct timeval t_timeout;
+   fd_set t_ready;
+   uint32_t i_index, i_pixels;
+   int i_window, i_tile, i_worker, i_socket, i_max;
+
+   for (i_worker = i_workers - 1; i_worker >= 0; i_worker--) /* Give each idle worker a tile */
+   {
+      if (x_worker[i_worker].b_busy) continue;
+      if (!b_next_tile(True, &i_window, &i_tile)) break; /* Nothing to hand out */
+      if (!i_send_tile(&x_worker[i_worker], i_window, i_tile))
+         v_drop_worker(i_worker);
+   }
+
+   FD_ZERO(&t_ready);
+   FD_SET(i_listen, &t_ready);
+   i_max = i_listen;
+   for (i_worker = 0; i_worker < i_workers; i_worker++)
+   {
+      FD_SET(x_worker[i_worker].i_socket, &t_ready);
+      if (x_worker[i_worker].i_socket > i_max) i_max = x_worker[i_worker].i_socket;
+   }
+   if (h_display != NULL)
+   {
+      FD_SET(ConnectionNumber(h_display), &t_ready);
+      if (ConnectionNumber(h_display) > i_max) i_max = ConnectionNumber(h_display);
+   }
+   t_timeout.tv_sec = 0;
+   t_timeout.tv_usec = 100000; /* Check for slow tiles regularly */
+   if (select(i_max + 1, &t_ready, NULL, NULL, &t_timeout) <= 0) return;
+
+   for (i_worker = i_workers - 1; i_worker >= 0; i_worker--)
+   {
+      if (!FD_ISSET(x_worker[i_worker].i_socket, &t_ready)) continue;
+      switch (i_receive(&x_worker[i_worker]))
+      {
+      case 0: /* Wait for the rest */
+         continue;
+      case -1:
+         v_drop_worker(i_worker); /* Worker has gone away */
+         continue;
+      }
+      p_reply = x_worker[i_worker].c_reply;
+      x_worker[i_worker].i_received = 0;
+      x_worker[i_worker].b_busy = False;
+      if (x_worker[i_worker].i_tile < 0) continue; /* Late reply for an earlier frame */
+
+      i_window = x_worker[i_worker].i_window;
+      i_tile = x_worker[i_worker].i_tile;
+      i_pixels = i_get32(p_reply + 12);
+      p_tile = &x_window[i_window].p_tiles[i_tile];
+      if (i_get32(p_reply + 4) != x_window[i_window].i_frame || i_get32(p_reply + 8) != (uint32_t)i_tile ||
+         i_pixels != p_tile->i_width * p_tile->i_height)
+      {
+         v_drop_worker(i_worker);
+         continue;
+      }
+      for (i_index = 0; i_index < i_pixels; i_index++)
+      {
+         i_count[i_index] = (p_reply[REPLY * 4 + 2 * i_index] << 8) | p_reply[REPLY * 4 + 2 * i_index + 1];
+         f_smooth[i_index] = unpack_float(i_get32(p_reply + REPLY * 4 + 2 * i_pixels + 4 * i_index));
+         if (i_count[i_index] > x_window[i_window].x_frame.i_maxiteration) break;
+      }
+      if (i_index < i_pixels) /* Can't be right, so let another worker do it */
+      {
+         v_drop_worker(i_worker);
+         continue;
+      }
+      x_worker[i_worker].i_tile = -1;
+      p_tile->i_copies--;
+      if (p_tile->b_done) continue; /* Another worker finished it first */
+      v_tile_done(&x_window[i_window], i_tile, i_count, f_smooth);
+   }
+
+   if (FD_ISSET(i_listen, &t_ready) && (i_socket = accept(i_listen, NULL, NULL)) >= 0)
+   {
+      if (i_workers < WORKERS)
+      {
+         debug(fprintf(stderr, "Accepted worker %d\n", i_socket));
+         fcntl(i_socket, F_SETFL, fcntl(i_socket, F_GETFL) | O_NONBLOCK); /* Never wait for a reply */
+         x_worker[i_workers].i_socket = i_socket;
+         x_worker[i_workers].i_received = 0;
+         x_worker[i_workers].b_busy = False;
+         x_worker[i_workers].i_window = 0;
+         x_worker[i_workers].i_tile = -1;
+         i_workers++;
+      }
+      else
+         close(i_socket);
+   }
+}
+
+#else /* Distributed rendering is not available */
+
+static void v_close_socket(char *s_address, int i_socket)
+{
+}
+
+static int i_open_socket(char *s_address, int b_listen)
+{
+   return -1;
+}
+
+static void v_worker(char *s_address)
+{
+   v_error("Cannot render tiles for '%s' on this host\n", s_address);
+}
+
+static void v_serve_workers()
+{
+}
+#endif
+
+static int b_start_frame(t_window *p_window) /* Start calculating the frame for a window, or redraw it if nothing has changed */
+{
+   t_view x_view;
+   Window x_root;
+   int i_left, i_top, i_worker, b_needed;
+   unsigned int i_width = i_window_width, i_height = i_window_height, i_border, i_depth;
+
+   /* Get window geometry - not everything will always be the same as the
+      values we requested for when we created the window - particularly if
+      it has been resized! */
+
+   if (p_window->x_handle != None && XGetGeometry(h_display, p_window->x_handle,
+         &x_root,
+         &i_left, &i_top,
+         &i_width,
+         &i_height,
+         &i_border,
+         &i_depth) == False)
+   {
+      return (False);
+   }
+
+   if (p_window->b_loaded)
+   {
+      v_redraw(p_window);
+      return True;
+   }
+
+   memset(&x_view, 0, sizeof(x_view)); /* So the views can be compared */
+   v_view(p_window, &x_view, i_width, i_height);
+
+   b_needed = x_view.b_smooth;
+   x_view.b_smooth |= p_window->x_frame.b_smooth; /* Smoothed iterations can be used even if they aren't needed */
+   if (p_window->p_count != NULL && !memcmp(&x_view, &p_window->x_frame, sizeof(x_view)))
+   {
+      v_redraw(p_window); /* Nothing has changed */
+      return True;
+   }
+   x_view.b_smooth = b_needed;
+
+   v_new_frame(p_window, &x_view);
+   v_begin_image(p_window);
+
+   b_symmetric(&x_view, &p_window->x_mirror);
+   free(p_window->p_tiles);
+   p_window->i_total = p_window->i_remaining = i_tiles(&x_view, &p_window->p_tiles, &p_window->x_mirror);
+   p_window->i_frame = ++i_frames;
+   for (i_worker = 0; i_worker < i_workers; i_worker++)
+      if (&x_window[x_worker[i_worker].i_window] == p_window)
+         x_worker[i_worker].i_tile = -1; /* Anything still being rendered belongs to an earlier frame */
+   if (p_window->i_remaining == 0) v_mirror(p_window);
+   return True;
+}
+
+static void v_benchmark(t_view *p_view) /* Compare the speed and accuracy of each kernel */
+{
+   const char *s_kernel[] = {"float", "fixed32", "fixed64"};
+   uint16_t *p_result[FIXED64 + 1];
+   long i_time[FIXED64 + 1];
+   t_window x_store;                      /* Somewhere to put the results */
+   t_tile *p_tiles;
+   t_tile x_mirror;
+   uint16_t i_count[TILE * TILE];
+   float f_smooth[TILE * TILE];
+   double f_resolution, f_step, f_extent;
+   unsigned long i_pixel, i_pixels, i_differences;
+   unsigned int i_index;
+   int i_total, i_tile, i_exponent;
+
+   memset(&x_store, 0, sizeof(x_store));
+   i_pixels = (unsigned long)p_view->i_width * p_view->i_height;
+   i_total = i_tiles(p_view, &p_tiles, NULL);
+   for (i_index = FLOAT; i_index <= FIXED64; i_index++)
+   {
+      p_result[i_index] = NULL;
+      if (!b_in_range(p_view, i_index)) continue; /* View is too large for this kernel */
+      p_view->i_kernel = i_index;
+      v_new_frame(&x_store, p_view);
+      i_time[i_index] = i_clock();
+      for (i_tile = 0; i_tile < i_total; i_tile++)
+      {
+         v_render_tile(p_view, &p_tiles[i_tile], i_count, f_smooth);
+         v_store_tile(&x_store, &p_tiles[i_tile], i_count, f_smooth);
+      }
+      i_time[i_index] = i_clock() - i_time[i_index];
+      if ((p_result[i_index] = malloc(sizeof(uint16_t) * i_pixels)) == NULL) v_error("Out of memory\n");
+      memcpy(p_result[i_index], x_store.p_count, sizeof(uint16_t) * i_pixels);
+   }
+   free(p_tiles);
+   free(x_store.p_count);
+   free(x_store.p_smooth);
+
+   /* Pixels stop being distinct once the step between them is less than
+      the resolution, so this limits how far the view can be zoomed.  For
+      floating point the resolution depends on the size of the coordinates
+      so the largest edge is used, and no kernel can do better than the
+      double precision edges of the view it is given.  Differences are pixels with a different
+      number of iterations to the 64 bit fixed point kernel, and kernels
+      that cannot be used for a view this large are not timed. */
+
+   f_step = fabs(p_view->f_xmax - p_view->f_xmin) / p_view->i_width;
+   if (fabs(p_view->f_ymax - p_view->f_ymin) / p_view->i_height < f_step)
+      f_step = fabs(p_view->f_ymax - p_view->f_ymin) / p_view->i_height;
+   f_extent = fabs(p_view->f_xmin);
+   if (fabs(p_view->f_xmax) > f_extent) f_extent = fabs(p_view->f_xmax);
+   if (fabs(p_view->f_ymin) > f_extent) f_extent = fabs(p_view->f_ymin);
+   if (fabs(p_view->f_ymax) > f_extent) f_extent = fabs(p_view->f_ymax);
+
+   fprintf(stdout, "%u x %u pixels, %u iterations\n", p_view->i_width, p_view->i_height, p_view->i_maxiteration);
+   fprintf(stdout, "Kernel     Time (ms)   Resolution   Zoom limit   Differences\n");
+   frexp(f_extent, &i_exponent);
+   for (i_index = FLOAT; i_index <= FIXED64; i_index++)
+   {
+      switch (i_index)
+      {
+      case FLOAT:
+         f_resolution = ldexp(1.0, i_exponent - 24); /* 24 bit mantissa */
+         break;
+      case FIXED32:
+         f_resolution = ldexp(1.0, -Q32);
+         break;
+      default:
+         f_resolution = ldexp(1.0, -Q64);
+      }
+      if (f_resolution < ldexp(1.0, i_exponent - 53)) f_resolution = ldexp(1.0, i_exponent - 53); /* 53 bit mantissa */
+      if (p_result[i_index] == NULL)
+      {
+         fprintf(stdout, "%-10s %9s %12.3g %12s %13s\n", s_kernel[i_index], "-", f_resolution, "-", "-");
+         continue;
+      }
+      fprintf(stdout, "%-10s %9ld %12.3g %11.3gx ", s_kernel[i_index], i_time[i_index], f_resolution, f_step / f_resolution);
+      if (p_result[FIXED64] != NULL)
+      {
+         i_differences = 0;
+         for (i_pixel = 0; i_pixel < i_pixels; i_pixel++)
+            if (p_result[i_index][i_pixel] != p_result[FIXED64][i_pixel]) i_differences++;
+         fprintf(stdout, "%13lu\n", i_differences);
+      }
+      else
+         fprintf(stdout, "%13s\n", "-");
+   }
+   for (i_index = FLOAT; i_index <= FIXED64; i_index++) free(p_result[i_index]);
+   if (b_symmetric(p_view, &x_mirror))
+      fprintf(stdout, "Symmetry saves calculating %lu of %lu pixels\n",
+         (unsigned long)x_mirror.i_width * x_mirror.i_height, i_pixels);
+}
+
+static void v_add_window(char *s_view) /* Add a window showing VIEW */
+{
+   t_window *p_window = &x_window[i_windows];
+   char *s_next = s_view;
+   int i_length;
+
+   if (i_windows >= WINDOWS) v_error("too many windows\n");
+   memset(p_window, 0, sizeof(t_window));
+   p_window->x_handle = None;
+   p_window->i_screen = -1;
+   p_window->f_zoom = 1;
+   if (sscanf(s_next, "%lf,%lf%n", &p_window->f_x, &p_window->f_y, &i_length) != 2) v_error("invalid window %s\n", s_view);
+   s_next += i_length;
+   if (sscanf(s_next, ",%lf%n", &p_window->f_zoom, &i_length) == 1) s_next += i_length;
+   if (sscanf(s_next, ":%d%n", &p_window->i_screen, &i_length) == 1) s_next += i_length;
+   if (sscanf(s_next, "+%d+%d%n", &p_window->i_left, &p_window->i_top, &i_length) == 2) s_next += i_length;
+   if (*s_next != 0 || p_window->f_zoom <= 0 || p_window->i_screen < -1) v_error("invalid window %s\n", s_view);
+   i_windows++;
+}
+
+static void v_open_window(t_window *p_window) /* Create a window on its screen and show it */
+{
+   if (p_window->i_screen < 0) p_window->i_screen = i_screen;
+   if (p_window->i_screen >= ScreenCount(h_display)) v_error("No screen %d on X server '%s'\n", p_window->i_screen, s_display_name);
+
+   p_window->x_handle = XCreateSimpleWindow(h_display, RootWindow(h_display, p_window->i_screen), /* Create the application window, as a child of the root window. */
+      p_window->i_left, p_window->i_top, /* Window position - the window manager may ignore it */
+      i_window_width, /* Window width */
+      i_window_height, /* Window height */
+      i_window_border, /* Border width - ignored ? */
+      BlackPixel(h_display, p_window->i_screen), /* Preferred method to set border colour to black */
+      WhitePixel(h_display, p_window->i_screen)); /* Preferred method to set background colour to white */
+
+   if (p_window->b_fullscreen)
+   {
+      /*
+       *  Display julia set in full screen maode by default
+       *
+       */
+      Atom wm_state = XInternAtom (h_display, "_NET_WM_STATE", True );
+      Atom wm_fullscreen = XInternAtom (h_display, "_NET_WM_STATE_FULLSCREEN", True );
+      XChangeProperty(h_display, p_window->x_handle, wm_state, XA_ATOM, 32, PropModeReplace, (unsigned char *)&wm_fullscreen, 1);
+   }
+
+   XStoreName(h_display, p_window->x_handle, s_title); /* Set the window title */
+
+   XSelectInput(h_display, p_window->x_handle, ExposureMask | KeyPressMask | ButtonPressMask | ButtonReleaseMask | /* Select events we are interested in, note ButtonPress is required for ButtonRelease */
+      StructureNotifyMask | VisibilityChangeMask | FocusChangeMask | EnterWindowMask | LeaveWindowMask); /* Track what can be seen to decide what to draw first */
+   XSync(h_display, False); /* Flush display before drawing (showing) the window! */
+   XMapWindow(h_display, p_window->x_handle); /*   Show the window */
+}
+
+static t_window *p_find_window(Window x_handle) /* Find the window an event is for */
+{
+   int i_index;
+   for (i_index = 0; i_index < i_windows; i_index++)
+      if (x_window[i_index].x_handle == x_handle) return &x_window[i_index];
+   return NULL;
+}
+
+static int i_main(int argc, char *argv[], char *s_view) /* Draw the views given on the command line, or s_view if there are none */
+{
+   t_view x_view;
+   t_window *p_window;
+   int i_count, i_index;
+   int b_fullscreen = False;
+   char b_abort = False; /* Stop processing command line */
+
+   for (i_count = 1; i_count < argc && (b_abort != True); i_count++)
+   {
+      if (argv[i_count][0] == '-')
+      {
+         i_index = 1;
+         while (argv[i_count][i_index] != 0)
+         {
+            switch (argv[i_count][i_index])
+            {
+               case 'b': /* Benchmark */
+                   b_benchmark = True; break;
+               case 'c': /* Smooth colours */
+                   b_smooth = True; break;
+               case 'f': /* Fullscreen */
+                   b_fullscreen = True; break;
+               case '?': /* Display help */
+                  v_about();
+               case '-': /* '--' terminates command line processing */
+                  i_index = strlen(argv[i_count]);
+                  if (i_index == 2)
+                    b_abort = True; /* '--' terminates command line processing */
+                  else
+                  {
+                     if (!strncmp(argv[i_count], "--listen=", 9))
+                     {
+                        s_listen = &argv[i_count][9];
+                     }
+                     else if (!strncmp(argv[i_count], "--worker=", 9))
+                     {
+                        s_worker = &argv[i_count][9];
+                     }
+                     else if (!strncmp(argv[i_count], "--output=", 9))
+                     {
+                        s_output = &argv[i_count][9];
+                     }
+                     else if (!strncmp(argv[i_count], "--save=", 7))
+                     {
+                        s_save = &argv[i_count][7];
+                     }
+                     else if (!strncmp(argv[i_count], "--load=", 7))
+                     {
+                        s_load = &argv[i_count][7];
+                     }
+                     else if (!strncmp(argv[i_count], "--crop=", 7))
+                     {
+                        s_crop = &argv[i_count][7];
+                     }
+                     else if (!strncmp(argv[i_count], "--window=", 9))
+                     {
+                        v_add_window(&argv[i_count][9]);
+                     }
+                     else if (!strncmp(argv[i_count], "--kernel=", 9))
+                     {
+                        if (!strcmp(&argv[i_count][9], "float"))
+                           i_kernel = FLOAT;
+                        else if (!strcmp(&argv[i_count][9], "fixed32"))
+                           i_kernel = FIXED32;
+                        else if (!strcmp(&argv[i_count][9], "fixed64"))
+                           i_kernel = FIXED64;
+                        else
+                           v_error("unknown kernel %s\n", &argv[i_count][9]);
+                     }
+                     else if (!strncmp(argv[i_count], "--geometry=", 11))
+                     {
+                        if (sscanf(&argv[i_count][11], "%ux%u", &i_window_width, &i_window_height) != 2 ||
+                           i_window_width == 0 || i_window_height == 0)
+                           v_error("invalid geometry %s\n", &argv[i_count][11]);
+                     }
+                     else if (!strncmp(argv[i_count], "--version", i_index))
+                     {
+                        v_version(); /* Display version information */
+                        exit(0);
+                     }
+                     else if (!strncmp(argv[i_count], "--fullscreen", i_index))
+                     {
+                        b_fullscreen = True;
+                     }
+                     else if (!strncmp(argv[i_count], "--smooth", i_index))
+                     {
+                        b_smooth = True;
+                     }
+                     else if (!strncmp(argv[i_count], "--compress", i_index))
+                     {
+                        b_compress = True;
+                     }
+                     else if (!strncmp(argv[i_count], "--benchmark", i_index))
+                     {
+                        b_benchmark = True;
+                     }
+                     else if (!strncmp(argv[i_count], "--no-symmetry", i_index))
+                     {
+                        b_symmetry = False;
+                     }
+                     else if (!strncmp(argv[i_count], "--help", i_index))
+                     {
+                        v_about();
+                     }
+                     else /* If we get here then the we have an invalid long option */
+                     {
+                        v_error("%s: invalid option %s\nTry '%s --help' for more information.\n", argv[i_count][i_index] , NAME);
+                        exit(-1);
+                     }
+                  }
+                  i_index--; /* Leave index pointing at end of string (so argv[i_count][i_index] = 0) */
+                  break;
+               default: /* If we get here the single letter option is unknown */
+                  v_error("unknown option -- %c\nTry '%s --help' for more information.\n", argv[i_count][i_index] , NAME);
+                  exit(-1);
+            }
+            i_index++; /* Parse next letter in options */
+         }
+         if (argv[i_count][1] != 0) {
+            for (i_index = i_count; i_index < argc - 1; i_index++) argv[i_index] = argv[i_index + 1];
+            argc--; i_count--;
+         }
+      }
+   }
+
+   if (s_worker != NULL) v_worker(s_worker); /* Never returns */
+
+   if (i_windows == 0) v_add_window(s_view);
+   for (i_index = 0; i_index < i_windows; i_index++) x_window[i_index].b_fullscreen = b_fullscreen;
+
+   if (b_benchmark)
+   {
+      v_view(&x_window[0], &x_view, i_window_width, i_window_height);
+      v_benchmark(&x_view);
+      exit(0);
+   }
+
+   if (s_load != NULL) /* Use saved iterations instead of calculating them */
+   {
+      v_load(&x_window[0], s_load);
+      if (s_crop != NULL) v_crop(&x_window[0], s_crop);
+      i_window_width = x_window[0].x_frame.i_width;
+      i_window_height = x_window[0].x_frame.i_height;
+   }
+
+   if (s_listen != NULL)
+   {
+      if ((i_listen = i_open_socket(s_listen, True)) < 0)
+         v_error("Cannot listen for workers on '%s'\n", s_listen);
+   }
+
+   if (s_output != NULL || s_save != NULL) /* Write image or iterations to a file without using the display */
+   {
+      if (s_output != NULL && (h_output = fopen(s_output, "wb")) == NULL)
+         v_error("Cannot open '%s'\n", s_output);
+      i_windows = 1; /* Only the first view can be written to a file */
+      b_start_frame(&x_window[0]);
+      while (x_window[0].i_remaining > 0)
+      {
+         if (i_listen >= 0)
+            v_serve_workers();
+         else
+            b_render_local();
+      }
+      if (h_output != NULL) fclose(h_output);
+      if (s_save != NULL) v_save(&x_window[0], s_save);
+      if (i_listen >= 0) v_close_socket(s_listen, i_listen);
+      exit(0);
+   }
+
+   h_display = XOpenDisplay(s_display_name); /*   Open a display. */
+
+   if (h_display) /*   If successful create and display a new window. */
+   {
+      x_root_window = DefaultRootWindow(h_display); /* Get the ID of the root window of the screen. */
+      i_screen = DefaultScreen(h_display); /* Get the default screen for our X server. */
+
+      for (i_index = 0; i_index < i_windows; i_index++)
+         v_open_window(&x_window[i_index]);
+      for (i_index = 0; i_index < i_windows && !b_abort; i_index++)
+         b_abort = !b_start_frame(&x_window[i_index]); /* Even windows that are never exposed need their tiles */
+
+      while (!b_abort)
+      {
+         if (!XPending(h_display)) /* Get on with calculating tiles until something happens */
+         {
+            if (i_listen >= 0)
+            {
+               v_serve_workers(); /* Returns as soon as there is an event waiting */
+               continue;
+            }
+            if (b_render_local()) continue;
+         }
+         XNextEvent(h_display, &x_event); /* Get next windows event */
+         if ((p_window = p_find_window(x_event.xany.window)) == NULL) continue;
+         switch (x_event.type)
+         {
+         case Expose: /* Redraw whatever has been calculated so far */
+            if (x_event.xexpose.count == 0) v_redraw(p_window);
+            break;
+         case ConfigureNotify: /* Start again if the size has changed */
+            if (!p_window->b_loaded &&
+               (x_event.xconfigure.width != (int)p_window->x_frame.i_width || x_event.xconfigure.height != (int)p_window->x_frame.i_height))
+               b_abort = !b_start_frame(p_window);
+            break;
+         case MapNotify:
+            p_window->b_mapped = True;
+            break;
+         case UnmapNotify:
+            p_window->b_mapped = False;
+            break;
+         case VisibilityNotify:
+            p_window->i_visibility = x_event.xvisibility.state;
+            break;
+         case FocusIn:
+         case FocusOut:
+            p_window->b_focus = (x_event.type == FocusIn);
+            break;
+         case EnterNotify:
+         case LeaveNotify:
+            p_window->b_pointer = (x_event.type == EnterNotify);
+            break;
+         case ButtonRelease:
+            break;
+         case KeyPress:
+            switch (XLookupKeysym(&x_event.xkey, 0))
+            {
+            case XK_Escape:
+               b_abort = True; /* Exit if a key is pressed */
+               break;
+            case XK_c:
+            case XK_C:
+               b_smooth = !b_smooth; /* Recolour, only recalculating frames without smoothed iterations */
+               for (i_index = 0; i_index < i_windows; i_index++)
+                  b_start_frame(&x_window[i_index]);
+               break;
+            case XK_f:
+            case XK_F:
+               if (p_window->b_fullscreen)
+                  v_fullscreen(p_window, 0);
+               else
+                  v_fullscreen(p_window, 1);
+               p_window->b_fullscreen = !p_window->b_fullscreen;
+            }
+         }
+      }
+      /* Close connection to server */
+      XCloseDisplay(h_display);
+      if (i_listen >= 0) v_close_socket(s_listen, i_listen);
+   }
+   else {
+      /* fprintf(stderr, "%s: cannot connect to X server '%s'\n", argv[0], s_display_name); */
+      v_error("Cannot connect to X server '%s'\n", s_display_name);
+   }
+   return 0;
+}
@@ -29,87 +29,47 @@
  *                        the number of iterations to be more then 255 - MT
  * 12 Oct 23            - Fixed overflow issues in hsv2rgb() - MT
  *                      - Tidied up fullscreen function - MT
- *
- * To Do                - Pass coefficents from the command line?
+ * 18 Oct 26            - Split the image into tiles that can be rendered
+ *                        by worker processes connected to a coordinator
+ *                        over a TCP or Unix socket
+ *                      - Added option to write the image to a file
+ *                      - Keep the iterations for each pixel so the image
+ *                        can be redrawn or recoloured, and saved to or
+ *                        loaded from a file
+ *                      - Added 32 and 64 bit fixed point kernels and  an
+ *                        option to compare their speed and accuracy
+ *                      - Only calculate one half of the image when it is
+ *                        symmetric about the origin
+ *                      - Show several views at once in windows on any
+ *                        screen, calculating the tiles for windows  that
+ *                        can be seen before those that can't
+ *                      - Moved the code shared with x11-mandlebrot into
+ *                        x11-fractal.h
+ *                      - Use floating point when the view is too large
+ *                        for the fixed point kernels
+ *                      - Keep the view in double precision so that the
+ *                        fixed point kernels can zoom further
+ *                      - Only calculate the smoothed iterations when they
+ *                        are used
+ *                      - Start calculating every window when it is opened
+ *                        rather than when it is first exposed
+ *                      - Save uncompressed iterations so they can be used
+ *                        straight from the mapped file, and record  the
+ *                        kernel used
  *
  */
 
-#include <stdio.h>                        /* fprintf(), etc. */
-#include <stdlib.h>                       /* exit(), etc. */
-#include <string.h>                       /* strlen(), etc */
-#include <stdarg.h>                       /* va_start(), va_end(), etc */
-#include <stdint.h>
-
-#include <math.h>
-
-#include <X11/Xlib.h>                     /* XOpenDisplay(), etc. */
-#include <X11/Xatom.h>                    /* XA_ATOM */
-#include <X11/keysym.h>
-
 #define  NAME           "x11-julia"
 #define  VERSION        "0.1"
 #define  BUILD          "0001"
 #define  AUTHOR         "MT"
 #define  DATE           "26 Sep 23"
 
-#if defined(DEBUG)
-#define debug(code) do {fprintf(stderr, "Debug\t: %s line : %d : ", \
-            __FILE__, __LINE__); code;} while(0)
-#else
-#define debug(code)
-#endif
-
-#define  WIDTH 800                        /* Define window size */
-#define  HEIGHT 600
-
-Display *h_display;                       /* Pointer to X display structure. */
-Window x_application_window;              /* Application window structure. */
-Window x_root_window;                     /* Root window structure. */
-XEvent x_event;
-Atom wm_state;
-Atom wm_fullscreen;
+#define  MAGIC 0x4a554c34                 /* Identifies requests and replies ('JUL4') */
+#define  FORMAT 0x4a554c44                /* Identifies a saved file ('JULD') */
+#define  VIEW "'CR,CI[,ZOOM][:SCREEN][+LEFT+TOP]'"
 
-unsigned int i_screen;                    /* Default screen number */
-unsigned int i_window_width = WIDTH ;     /* Window width in pixels. */
-unsigned int i_window_height = HEIGHT ;   /* Window height in pixels. */
-unsigned int i_window_border = 4 ;        /* Window's border width. */
-unsigned int i_background_colour;         /* Window's background colour. */
-unsigned int i_colour_depth;              /* Window's colour depth. */
-
-int i_window_left, i_window_top;          /* Location of the window's top-left corner - relative to parent window. */
-int i_KeyEventCode;
-
-char *s_display_name = "";                /* Just use the default display. */
-char *s_title = NAME;                     /* Windows title */
-
-void v_version() /* Display version information */
-{
-   fprintf(stdout, "%s: Version %s", NAME, VERSION);
-   if (__DATE__[4] == ' ') fprintf(stdout, " 0"); else fprintf(stdout, " %c", __DATE__[4]);
-   fprintf(stdout, "%c %c%c%c %s %s", __DATE__[5],
-      __DATE__[0], __DATE__[1], __DATE__[2], &__DATE__[9], __TIME__ );
-   fprintf(stdout, " (Build: %s)\n", BUILD );
-}
-
-void v_about() /* Display help text */
-{
-   fprintf(stdout, "Usage: %s [OPTION]...\n", NAME);
-   fprintf(stdout, "Display Mandlebrot or Juila set.\n\n");
-   fprintf(stdout, "  -f, --fullscreen         display in fullscreen window\n");
-   fprintf(stdout, "  -?, --help               display this help and exit\n");
-   fprintf(stdout, "      --version            output version information and exit\n");
-   exit(0);
-}
-
-void v_error(const char *s_format, ...) /* Print formatted error message and exit */
-{
-   va_list t_args;
-   va_start(t_args, s_format);
-   fprintf(stderr, "%s : ", __FILE__);
-   vfprintf(stderr, s_format, t_args);
-   va_end(t_args);
-   exit(-1);
-}
+#include "x11-fractal.h"
 
 void v_set_blank_cursor(Display *x_display, Window x_application_window, Cursor *x_cursor)
 {
@@ -121,256 +81,234 @@ void v_set_blank_cursor(Display *x_display, Window x_application_window, Cursor
    XFreePixmap (x_display, x_blank); /* Free up pixmap */
 }
 
-void v_fullscreen(int i_state)
-{
-   XEvent x_event;
-   Atom wm_fullscreen;
+/* The fixed point kernels give the same iterations on every host.  Each
+   one iterates LANES pixels at a time, using masks rather than branches
+   to freeze the pixels that have escaped, so the inner loops can be done
+   with integer vector instructions by compilers that support them. */
 
-   x_event.type = ClientMessage;
-   x_event.xclient.window = x_application_window;
-   x_event.xclient.message_type = XInternAtom(h_display, "_NET_WM_STATE", False);
-   x_event.xclient.format = 32;
-   x_event.xclient.data.l[0] = i_state;
-   wm_fullscreen = XInternAtom(h_display, "_NET_WM_STATE_FULLSCREEN", False);
-   x_event.xclient.data.l[1] = wm_fullscreen;
-   x_event.xclient.data.l[2] = 0;
-   XSendEvent(h_display, RootWindow(h_display, i_screen), False, ClientMessage, &x_event);
-}
-
-uint32_t pack(uint8_t a, uint8_t b, uint8_t c)
+void v_render_fixed32(t_view *p_view, t_tile *p_tile, uint16_t *p_count, float *p_smooth)
 {
-   return((((((uint32_t)a) << 8) + b) << 8) + c);
+   int32_t zr[LANES], zi[LANES];
+   int32_t cr = i_fixed(p_view->cr, Q32), ci = i_fixed(p_view->ci, Q32);
+   int64_t zr2, zi2, temp;
+   int64_t i_xmin = i_fixed(p_view->f_xmin, Q32);
+   int64_t i_ymin = i_fixed(p_view->f_ymin, Q32);
+   int64_t i_xrange = i_fixed(p_view->f_xmax, Q32) - i_xmin; /* Scale before dividing to keep the precision */
+   int64_t i_yrange = i_fixed(p_view->f_ymax, Q32) - i_ymin;
+   int64_t i_limit = (int64_t)4 << (2 * Q32); /* Radius squared */
+   int32_t i_count[LANES];
+   int32_t b_done[LANES];
+   int32_t i_mask, i_active;
+   unsigned int x, y, i, i_lane;
+
+   for (y = p_tile->i_top; y < p_tile->i_top + p_tile->i_height; y++)
+   {
+      for (x = p_tile->i_left; x < p_tile->i_left + p_tile->i_width; x += LANES)
+      {
+         for (i_lane = 0; i_lane < LANES; i_lane++)
+         {
+            zr[i_lane] = i_xmin + i_xrange * (x + i_lane) / (int64_t)p_view->i_width;
+            zi[i_lane] = i_ymin + i_yrange * y / (int64_t)p_view->i_height;
+            i_count[i_lane] = 0;
+            b_done[i_lane] = (x + i_lane >= p_tile->i_left + p_tile->i_width); /* Spare lanes */
+         }
+         for (i = 0; i < p_view->i_maxiteration; i++)
+         {
+            i_active = 0;
+            for (i_lane = 0; i_lane < LANES; i_lane++)
+            {
+               zr2 = (int64_t)zr[i_lane] * zr[i_lane];
+               zi2 = (int64_t)zi[i_lane] * zi[i_lane];
+               b_done[i_lane] |= ((uint64_t)zr2 + zi2 >= (uint64_t)i_limit); /* Unsigned so the sum cannot overflow */
+               temp = i_shift(zr2 - zi2, Q32) + cr;
+               zi2 = i_shift((int64_t)zr[i_lane] * zi[i_lane], Q32 - 1) + ci;
+               i_mask = b_done[i_lane] - 1; /* All ones until the pixel escapes */
+               zr[i_lane] = (zr[i_lane] & ~i_mask) | ((int32_t)temp & i_mask);
+               zi[i_lane] = (zi[i_lane] & ~i_mask) | ((int32_t)zi2 & i_mask);
+               i_count[i_lane] += !b_done[i_lane];
+               i_active += !b_done[i_lane];
+            }
+            if (i_active == 0) break;
+         }
+         for (i_lane = 0; i_lane < LANES && x + i_lane < p_tile->i_left + p_tile->i_width; i_lane++)
+         {
+            *p_count++ = i_count[i_lane];
+            if (p_view->b_smooth && i_count[i_lane] < (int32_t)p_view->i_maxiteration)
+               *p_smooth++ = i_count[i_lane] + 1 - log(log(ldexp((double)zr[i_lane] * zr[i_lane] +
+                  (double)zi[i_lane] * zi[i_lane], -2 * Q32)) / 2) / log(2);
+            else
+               *p_smooth++ = i_count[i_lane];
+         }
+      }
+   }
 }
 
-uint32_t hsv2rgb(uint8_t h, uint8_t s, uint8_t v)
+void v_render_fixed64(t_view *p_view, t_tile *p_tile, uint16_t *p_count, float *p_smooth)
 {
-   uint16_t i, m;
-   uint8_t r, g, b;
-   uint8_t p, q, t;
-   
-   if (s == 0)
-   {
-      r = v;
-      g = v;
-      b = v;
-      return pack(r, g, b);
-   }
-   
-   i = (uint16_t)h / 43;
-   m = ((uint16_t)h - (i * 43)) * 6; 
-   
-   p = ((uint16_t)v * (255 - (uint16_t)s)) >> 8;
-   q = ((uint16_t)v * (255 - (((uint16_t)s * m) >> 8))) >> 8;
-   t = ((uint16_t)v * (255 - (((uint16_t)s * (255 - m)) >> 8))) >> 8;
-   
-   switch (i)
+   int64_t zr[LANES], zi[LANES];
+   int64_t cr = i_fixed(p_view->cr, Q64), ci = i_fixed(p_view->ci, Q64);
+   uint64_t zr2, zi2, temp;               /* Unsigned so they wrap rather than overflow */
+   int64_t i_xmin = i_fixed(p_view->f_xmin, Q64);
+   int64_t i_ymin = i_fixed(p_view->f_ymin, Q64);
+   int64_t i_xdelta = (i_fixed(p_view->f_xmax, Q64) - i_xmin) / (int64_t)p_view->i_width;
+   int64_t i_ydelta = (i_fixed(p_view->f_ymax, Q64) - i_ymin) / (int64_t)p_view->i_height;
+   uint64_t i_limit = (uint64_t)4 << Q64; /* Radius squared */
+   int64_t i_radius = (int64_t)2 << Q64;
+   int32_t i_count[LANES];
+   int32_t b_done[LANES];
+   int64_t i_mask;
+   int32_t i_active;
+   unsigned int x, y, i, i_lane;
+
+   for (y = p_tile->i_top; y < p_tile->i_top + p_tile->i_height; y++)
    {
-      case 0:
-         r = v; g = t; b = p;
-         break;
-      case 1:
-         r = q; g = v; b = p;
-         break;
-      case 2:
-         r = p; g = v; b = t;
-         break;
-      case 3:
-         r = p; g = q; b = v;
-         break;
-      case 4:
-         r = t; g = p; b = v;
-         break;
-      default:
-         r = v; g = p; b = q;
-         break;
+      for (x = p_tile->i_left; x < p_tile->i_left + p_tile->i_width; x += LANES)
+      {
+         for (i_lane = 0; i_lane < LANES; i_lane++)
+         {
+            zr[i_lane] = i_xmin + (int64_t)(x + i_lane) * i_xdelta;
+            zi[i_lane] = i_ymin + (int64_t)y * i_ydelta;
+            i_count[i_lane] = 0;
+            b_done[i_lane] = (x + i_lane >= p_tile->i_left + p_tile->i_width); /* Spare lanes */
+         }
+         for (i = 0; i < p_view->i_maxiteration; i++)
+         {
+            i_active = 0;
+            for (i_lane = 0; i_lane < LANES; i_lane++)
+            {
+               zr2 = i_mul64(zr[i_lane], zr[i_lane]);
+               zi2 = i_mul64(zi[i_lane], zi[i_lane]);
+               b_done[i_lane] |= (zr[i_lane] >= i_radius) | (zr[i_lane] <= -i_radius) |
+                  (zi[i_lane] >= i_radius) | (zi[i_lane] <= -i_radius) | /* Squares are only valid inside the radius */
+                  (zr2 + zi2 >= i_limit);
+               temp = zr2 - zi2 + (uint64_t)cr;
+               zi2 = 2 * (uint64_t)i_mul64(zr[i_lane], zi[i_lane]) + (uint64_t)ci;
+               i_mask = (int64_t)b_done[i_lane] - 1; /* All ones until the pixel escapes */
+               zr[i_lane] = (zr[i_lane] & ~i_mask) | ((int64_t)temp & i_mask);
+               zi[i_lane] = (zi[i_lane] & ~i_mask) | ((int64_t)zi2 & i_mask);
+               i_count[i_lane] += !b_done[i_lane];
+               i_active += !b_done[i_lane];
+            }
+            if (i_active == 0) break;
+         }
+         for (i_lane = 0; i_lane < LANES && x + i_lane < p_tile->i_left + p_tile->i_width; i_lane++)
+         {
+            *p_count++ = i_count[i_lane];
+            if (p_view->b_smooth && i_count[i_lane] < (int32_t)p_view->i_maxiteration)
+               *p_smooth++ = i_count[i_lane] + 1 - log(log(ldexp((double)zr[i_lane], -Q64) * ldexp((double)zr[i_lane], -Q64) +
+                  ldexp((double)zi[i_lane], -Q64) * ldexp((double)zi[i_lane], -Q64)) / 2) / log(2);
+            else
+               *p_smooth++ = i_count[i_lane];
+         }
+      }
    }
-   return pack(r, g, b);
 }
 
-int v_draw_julia_set(float cr, float ci)
+void v_render_tile(t_view *p_view, t_tile *p_tile, uint16_t *p_count, float *p_smooth) /* Count iterations for each pixel in a tile */
 {
-   const float f_xmin = -1.55;            /* Left edge      */
-   const float f_xmax = 1.55;             /* Right edge     */
-   const float f_ymin = -0.9;             /* Top edge       */
-   const float f_ymax = 0.9;              /* Bottom edge    */
-   const int i_maxiteration = 224;        /* Iterations     */
-
-   float f_xdelta = 0.00375;              /* X step size    */
-   float f_ydelta = 0.0033;               /* Y step size    */
-
+   float f_xmin = p_view->f_xmin, f_xmax = p_view->f_xmax; /* Single precision copies of the view */
+   float f_ymin = p_view->f_ymin, f_ymax = p_view->f_ymax;
+   float f_xdelta = (f_xmin - f_xmax) / p_view->i_width;
+   float f_ydelta = (f_ymin - f_ymax) / p_view->i_height;
+   float cr = p_view->cr, ci = p_view->ci;
    float zr, zi, temp;
    float r = 2.0;                         /* Radius         */
    float x, y;
+   unsigned int i;
 
-   int i_colour;
-   int i;
-
-   /* Get window geometry - not everything will always be the same as the
-      values we requested for when we created the window - particularly if
-      it has been resized! */
-
-   if (XGetGeometry(h_display, x_application_window,
-         &RootWindow(h_display, i_screen),
-         &i_window_left, &i_window_top,
-         &i_window_width,
-         &i_window_height,
-         &i_window_border,
-         &i_colour_depth) == False)
+   if (p_view->i_kernel == FIXED32)
+   {
+      v_render_fixed32(p_view, p_tile, p_count, p_smooth);
+      return;
+   }
+   if (p_view->i_kernel == FIXED64)
    {
-      return (False);
+      v_render_fixed64(p_view, p_tile, p_count, p_smooth);
+      return;
    }
 
-   f_xdelta = (f_xmin - f_xmax) / i_window_width;
-   f_ydelta = (f_ymin - f_ymax) / i_window_height;
-   for (y = 0; y < i_window_height; y++)
+   for (y = p_tile->i_top; y < p_tile->i_top + p_tile->i_height; y++)
    {
-      for (x = 0; x < i_window_width; x++)
+      for (x = p_tile->i_left; x < p_tile->i_left + p_tile->i_width; x++)
       {
          zr = f_xmin - (x * f_xdelta);
          zi = f_ymin - (y * f_ydelta);
          i = 0;
-         while ((((zr*zr) + (zi*zi)) < r*r) && (i < i_maxiteration))
+         while ((((zr*zr) + (zi*zi)) < r*r) && (i < p_view->i_maxiteration))
          {
             temp = zr*zr - zi*zi;
             zi = 2 * zr * zi + ci;
             zr = temp + cr;
             i++;
          }
-         i_colour = hsv2rgb(255 * ((float)i / i_maxiteration) , 255, 128);
-         if (i == i_maxiteration)
-            XSetForeground(h_display, DefaultGC(h_display, i_screen), BlackPixel(h_display, i_screen));
+         *p_count++ = i;
+         if (p_view->b_smooth && i < p_view->i_maxiteration) /* Remove the bands by allowing for how far the point escaped */
+            *p_smooth++ = i + 1 - log(log(zr*zr + zi*zi) / 2) / log(2);
          else
-            XSetForeground(h_display, DefaultGC(h_display, i_screen), i_colour);
-         XDrawPoint(h_display, x_application_window, DefaultGC(h_display, i_screen), x, y);
-         XFlush(h_display);
+            *p_smooth++ = i;
       }
    }
-   return True;
 }
 
-int main(int argc, char *argv[])
+/* A julia set is symmetric about the origin, so if the pixels either side
+   of it line up the bottom half can be copied from the top half by turning
+   it upside down.  The part that can be copied is returned in p_mirror. */
+
+int b_symmetric(t_view *p_view, t_tile *p_mirror)
 {
-   int i_count, i_index;
-   int b_fullscreen = False;
-   char b_abort = False; /* Stop processing command line */
+   long i_xaxis = i_axis(p_view->f_xmin, p_view->f_xmax, p_view->i_width);
+   long i_yaxis = i_axis(p_view->f_ymin, p_view->f_ymax, p_view->i_height);
+
+   p_mirror->i_width = 0;
+   p_mirror->i_height = 0;
+   if (!b_symmetry || i_xaxis < 0 || i_yaxis < 0) return False;
+   p_mirror->i_left = (i_xaxis > (long)p_view->i_width - 1) ? i_xaxis - (p_view->i_width - 1) : 0;
+   p_mirror->i_width = ((i_xaxis < (long)p_view->i_width - 1) ? i_xaxis : p_view->i_width - 1) - p_mirror->i_left + 1;
+   p_mirror->i_top = i_yaxis / 2 + 1;
+   p_mirror->i_height = ((i_yaxis < (long)p_view->i_height - 1) ? i_yaxis : p_view->i_height - 1) - p_mirror->i_top + 1;
+   return True;
+}
 
-   for (i_count = 1; i_count < argc && (b_abort != True); i_count++)
+void v_mirror(t_window *p_window) /* Copy the mirrored part of the stored frame and draw it */
+{
+   t_view *p_frame = &p_window->x_frame;
+   t_tile *p_mirror = &p_window->x_mirror;
+   long i_xaxis = i_axis(p_frame->f_xmin, p_frame->f_xmax, p_frame->i_width);
+   long i_yaxis = i_axis(p_frame->f_ymin, p_frame->f_ymax, p_frame->i_height);
+   unsigned long i_pixel, i_source;
+   unsigned int x, y;
+
+   if (p_mirror->i_width == 0 || p_mirror->i_height == 0) return;
+   for (y = p_mirror->i_top; y < p_mirror->i_top + p_mirror->i_height; y++)
    {
-      if (argv[i_count][0] == '-')
+      for (x = p_mirror->i_left; x < p_mirror->i_left + p_mirror->i_width; x++)
       {
-         i_index = 1;
-         while (argv[i_count][i_index] != 0)
-         {
-            switch (argv[i_count][i_index])
-            {
-               case 'f': /* Fullscreen */
-                   b_fullscreen = True; break;
-               case '?': /* Display help */
-                  v_about();
-               case '-': /* '--' terminates command line processing */
-                  i_index = strlen(argv[i_count]);
-                  if (i_index == 2)
-                    b_abort = True; /* '--' terminates command line processing */
-                  else
-                  {
-                     if (!strncmp(argv[i_count], "--version", i_index))
-                     {
-                        v_version(); /* Display version information */
-                        exit(0);
-                     }
-                     else if (!strncmp(argv[i_count], "--fullscreen", i_index))
-                     {
-                        b_fullscreen = True;
-                     }
-                     else if (!strncmp(argv[i_count], "--help", i_index))
-                     {
-                        v_about();
-                     }
-                     else /* If we get here then the we have an invalid long option */
-                     {
-                        v_error("%s: invalid option %s\nTry '%s --help' for more information.\n", argv[i_count][i_index] , NAME);
-                        exit(-1);
-                     }
-                  }
-                  i_index--; /* Leave index pointing at end of string (so argv[i_count][i_index] = 0) */
-                  break;
-               default: /* If we get here the single letter option is unknown */
-                  v_error("unknown option -- %c\nTry '%s --help' for more information.\n", argv[i_count][i_index] , NAME);
-                  exit(-1);
-            }
-            i_index++; /* Parse next letter in options */
-         }
-         if (argv[i_count][1] != 0) {
-            for (i_index = i_count; i_index < argc - 1; i_index++) argv[i_index] = argv[i_index + 1];
-            argc--; i_count--;
-         }
+         i_pixel = (unsigned long)y * p_window->i_stride + x;
+         i_source = (unsigned long)(i_yaxis - y) * p_window->i_stride + (i_xaxis - x);
+         p_window->p_count[i_pixel] = p_window->p_count[i_source];
+         p_window->p_smooth[i_pixel] = p_window->p_smooth[i_source];
       }
    }
+   v_draw_tile(p_window, p_mirror);
+}
 
-   h_display = XOpenDisplay(s_display_name); /*   Open a display. */
-
-   if (h_display) /*   If successful create and display a new window. */
-   {
-      x_root_window = DefaultRootWindow(h_display); /* Get the ID of the root window of the screen. */
-      i_screen = DefaultScreen(h_display); /* Get the default screen for our X server. */
-
-      x_application_window = XCreateSimpleWindow(h_display, RootWindow(h_display, i_screen), /* Create the application window, as a child of the root window. */
-         i_window_width, i_window_height, /* Window position -igore ? */
-         i_window_width, /* Window width */
-         i_window_height, /* Window height */
-         i_window_border, /* Border width - ignored ? */
-         BlackPixel(h_display, i_screen), /* Preferred method to set border colour to black */
-         WhitePixel(h_display, i_screen)); /* Preferred method to set background colour to white */
-
-      if (b_fullscreen)
-      {
-         /*
-          *  Display julia set in full screen maode by default
-          *
-          */
-         Atom wm_state = XInternAtom (h_display, "_NET_WM_STATE", True );
-         Atom wm_fullscreen = XInternAtom (h_display, "_NET_WM_STATE_FULLSCREEN", True );
-         XChangeProperty(h_display, x_application_window, wm_state, XA_ATOM, 32, PropModeReplace, (unsigned char *)&wm_fullscreen, 1);
-      }
-
-      XStoreName(h_display, x_application_window, s_title); /* Set the window title */
-
-      XSync(h_display, False); /* Flush display before drawing (showing) the window! */
-      XMapWindow(h_display, x_application_window); /*   Show the window */
-      XSelectInput(h_display, x_application_window, ExposureMask | KeyPressMask | ButtonPressMask | ButtonReleaseMask);  /* Select events we are interested in, note ButtonPress is required for ButtonRelease */
+void v_view(t_window *p_window, t_view *p_view, unsigned int i_width, unsigned int i_height) /* Work out what to draw in a window */
+{
+   p_view->f_xmin = -1.55 / p_window->f_zoom; /* Left edge      */
+   p_view->f_xmax = 1.55 / p_window->f_zoom; /* Right edge     */
+   p_view->f_ymin = -0.9 / p_window->f_zoom; /* Top edge       */
+   p_view->f_ymax = 0.9 / p_window->f_zoom; /* Bottom edge    */
+   p_view->i_maxiteration = 224;          /* Iterations     */
+   p_view->cr = p_window->f_x;
+   p_view->ci = p_window->f_y;
+   p_view->i_width = i_width;
+   p_view->i_height = i_height;
+   p_view->i_kernel = i_kernel;
+   p_view->b_smooth = b_smooth || s_save != NULL; /* Only calculate smoothed iterations if they will be used */
+   if (!b_in_range(p_view, i_kernel)) p_view->i_kernel = FLOAT; /* Too far out for fixed point */
+}
 
-      while (!b_abort)
-      {
-         XNextEvent(h_display, &x_event); /* Get next windows event */
-         switch (x_event.type)
-         {
-         case Expose: /* Draw or redraw the window */
-            b_abort = !v_draw_julia_set(-0.79, 0.15); /* Try (-0.79, 0.15), (-0.75, 0.11) or (-0.74543, 0.11301) */
-            break;
-         case ButtonRelease:
-            break;
-         case KeyPress:
-            switch (XLookupKeysym(&x_event.xkey, 0))
-            {
-            case XK_Escape:
-               b_abort = True; /* Exit if a key is pressed */
-               break;
-            case XK_f:
-            case XK_F:
-               if (b_fullscreen)
-                  v_fullscreen(0);
-               else
-                  v_fullscreen(1);
-               b_fullscreen = !b_fullscreen;
-            }
-         }
-      }
-      /* Close connection to server */
-      XCloseDisplay(h_display);
-   }
-   else {
-      /* fprintf(stderr, "%s: cannot connect to X server '%s'\n", argv[0], s_display_name); */
-      v_error("Cannot connect to X server '%s'\n", s_display_name);
-   }
-   exit(0);
+int main(int argc, char *argv[])
+{
+   return i_main(argc, argv, "-0.79,0.15"); /* Try (-0.79, 0.15), (-0.75, 0.11) or (-0.74543, 0.11301) */
 }